@@ -0,0 +1,100 @@
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include "analyze.h"
+#include "fen.h"
+#include "movegen.h"
+#include "search.h"
+
+//Positions are handed out in blocks of this many per thread, and the results of a block are written before the next is read
+const size_t BLOCK_PER_THREAD = 4096;
+
+std::string analyzePosition(const std::string& record, int depth, TranspositionTable* tt){
+    ChessBoard chessBoard;
+    if(!setupPosition(&chessBoard, record))
+        return record + "\tinvalid";
+    //The moves are generated once and tell both their count and whether the game is over
+    LegalMoveCache legal;
+    std::string status = statusName(gameStatus(&chessBoard, legal));
+    if(status == "playing")
+        status = (chessBoard.inCheck()? "check" : "none");
+    std::string result = record + "\t" + std::to_string(legal.count()) + "\t" + status;
+
+    if(depth > 0 && legal.count() > 0){
+        Search search(&chessBoard, *tt, std::vector<uint64_t>(1, chessBoard.getKey()));
+        int score = 0;
+        search.onIteration = [&score](const SearchReport& report){score = report.score;};
+        SearchLimits limits;
+        limits.depth = depth;
+        //Entries left by the worker's earlier positions would make the result depend on how positions were shared out
+        tt->clear();
+        Move best = search.run(limits);
+        result += "\t" + moveToString(best) + "\t" + std::to_string(score);
+    }
+    return result;
+}
+
+int analyzeCommand(int argc, char* argv[]){
+    if(argc < 3){
+        std::cout<<"Usage: chess analyze <epd file> [depth] [threads]\n";
+        return 1;
+    }
+    std::ifstream input(argv[2]);
+    if(!input){
+        std::cout<<"Cannot open "<<argv[2]<<"\n";
+        return 1;
+    }
+    int depth = (argc > 3? atoi(argv[3]) : 0);
+    int threads = (argc > 4? atoi(argv[4]) : int(std::thread::hardware_concurrency()));
+    if(threads < 1)
+        threads = 1;
+
+    //Each worker has a table of its own, cleared before every position so that results do not depend on the
+    //number of threads. It is kept small because clearing it is part of every position's cost.
+    std::vector<std::unique_ptr<TranspositionTable>> tables;
+    for(int i = 0; i < threads && depth > 0; i++)
+        tables.emplace_back(new TranspositionTable(2));
+
+    std::vector<std::string> records, results;
+    std::string line, output;
+    uint64_t positions = 0;
+    auto start = std::chrono::steady_clock::now();
+    while(input){
+        records.clear();
+        while(records.size() < BLOCK_PER_THREAD * threads && std::getline(input, line)){
+            if(line.find_first_not_of(" \t\r") != std::string::npos)
+                records.push_back(line.substr(0, line.find_last_not_of(" \t\r") + 1));
+        }
+        results.assign(records.size(), std::string());
+
+        std::atomic<size_t> next{0};
+        auto work = [&](int worker){
+            TranspositionTable* tt = (depth > 0? tables[worker].get() : nullptr);
+            for(size_t i = next++; i < records.size(); i = next++)
+                results[i] = analyzePosition(records[i], depth, tt);
+        };
+        std::vector<std::thread> workers;
+        for(int i = 1; i < threads; i++)
+            workers.emplace_back(work, i);
+        work(0);
+        for(std::thread& worker: workers)
+            worker.join();
+
+        //Results come out in the order the records went in, written a block at a time
+        output.clear();
+        for(const std::string& result: results)
+            output += result + "\n";
+        std::cout<<output;
+        positions += records.size();
+    }
+    std::cout.flush();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr<<positions<<" positions in "<<seconds<<" s, "<<uint64_t(positions / (seconds > 0? seconds : 1e-9))<<" positions/s\n";
+    return 0;
+}
@@ -0,0 +1,13 @@
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include <string>
+#include "chess.h"
+#include "tt.h"
+
+//One line of batch output: the record, its legal move count and status, and the best move when searched to depth
+std::string analyzePosition(const std::string& record, int depth, TranspositionTable* tt);
+//Entry point for "chess analyze <epd file> [depth] [threads]"
+int analyzeCommand(int argc, char* argv[]);
+
+#endif
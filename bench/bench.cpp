@@ -0,0 +1,323 @@
+//Microbenchmarks of the rules and search building blocks over fixed positions. Each benchmark repeats until it has
+//run for the time asked and reports the time per operation; the results can be written as JSON and compared with
+//an earlier run to catch regressions.
+//
+//  chess_bench [--filter <text>] [--time <seconds>] [--json <file>] [--compare <baseline json> [--threshold <percent>]]
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "chess.h"
+#include "eval.h"
+#include "fen.h"
+#include "movegen.h"
+#include "nnue.h"
+#include "perft.h"
+#include "zobrist.h"
+
+//The perft reference positions, for throughput across all kinds of moves
+static const char* mixedPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+//Checkmates, checks that can be answered and a stalemate, for the end of game tests
+static const char* checkPositions[] = {
+    "r1bqkb1r/pppp1Qpp/2n2n2/4p3/2B1P3/8/PPPP1PPP/RNB1K1NR b KQkq - 0 4",
+    "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+    "R5k1/5ppp/8/8/8/8/8/6K1 b - - 0 1",
+    "6rk/5Npp/8/8/8/8/8/6K1 b - - 0 1",
+    "rnbqkbnr/ppp2ppp/3p4/1B2p3/4P3/8/PPPP1PPP/RNBQK1NR b KQkq - 1 3",
+    "rnbqk1nr/pppp1ppp/8/4p3/1b2P3/3P4/PPP2PPP/RNBQKBNR w KQkq - 1 3",
+    "4k3/8/8/8/8/8/3q4/4K3 w - - 0 1",
+    "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1",
+};
+
+struct BenchResult{
+    std::string name;
+    uint64_t operations;
+    double seconds;
+    double nanosecondsPerOperation() const {return seconds * 1e9 / (operations > 0? operations : 1);}
+};
+
+//Keeps results alive so the optimiser cannot drop the work that produced them
+static volatile uint64_t sink;
+
+static std::vector<ChessBoard> loadPositions(const char* const fens[], size_t count){
+    std::vector<ChessBoard> boards(count);
+    for(size_t i = 0; i < count; i++){
+        if(!setupPosition(&boards[i], fens[i])){
+            std::cerr<<"Invalid benchmark position "<<fens[i]<<"\n";
+            exit(1);
+        }
+    }
+    return boards;
+}
+
+//Runs round, which returns the operations it did, until minimum seconds have passed and at least three rounds ran
+static BenchResult measure(const std::string& name, double minimum, const std::function<uint64_t()>& round){
+    BenchResult result = {name, 0, 0};
+    round();
+    for(int rounds = 0; rounds < 3 || result.seconds < minimum; rounds++){
+        auto start = std::chrono::steady_clock::now();
+        result.operations += round();
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
+
+static void defineBenchmarks(std::vector<std::pair<std::string, std::function<uint64_t()>>>& benchmarks){
+    static std::vector<ChessBoard> mixed = loadPositions(mixedPositions, sizeof(mixedPositions) / sizeof(mixedPositions[0]));
+    static std::vector<ChessBoard> checks = loadPositions(checkPositions, sizeof(checkPositions) / sizeof(checkPositions[0]));
+
+    //Every square asked about for both colors
+    benchmarks.emplace_back("isThreatened", [](){
+        uint64_t found = 0;
+        for(ChessBoard& chessBoard: mixed){
+            for(int square = 0; square < 64; square++)
+                found += chessBoard.isThreatened(square, WHITE) + chessBoard.isThreatened(square, BLACK);
+        }
+        sink = found;
+        return uint64_t(mixed.size() * 128);
+    });
+    benchmarks.emplace_back("allAttackersTo", [](){
+        uint64_t found = 0;
+        for(ChessBoard& chessBoard: mixed){
+            for(int square = 0; square < 64; square++)
+                found += popCount(chessBoard.allAttackersTo(square, chessBoard.getOccupancy()));
+        }
+        sink = found;
+        return uint64_t(mixed.size() * 64);
+    });
+    //Every piece of the side to move to every square, the way typed moves are checked
+    benchmarks.emplace_back("checkMove", [](){
+        uint64_t legal = 0, checked = 0;
+        for(ChessBoard& chessBoard: mixed){
+            Bitboard own = chessBoard.getColorPieces(chessBoard.getTurn());
+            while(own){
+                int source = popLsb(own);
+                for(int destination = 0; destination < 64; destination++){
+                    Move move;
+                    if(destination != source && checkMove(&chessBoard, source, destination, chessBoard.getTurn(), move) == nullptr)
+                        legal++;
+                    checked++;
+                }
+            }
+        }
+        sink = legal;
+        return checked;
+    });
+    //The same checks against the position's legal moves, worked out once as the game loop does each turn
+    benchmarks.emplace_back("legalMoveCache", [](){
+        uint64_t legal = 0, checked = 0;
+        LegalMoveCache cache;
+        for(ChessBoard& chessBoard: mixed){
+            cache.update(&chessBoard);
+            Bitboard own = chessBoard.getColorPieces(chessBoard.getTurn());
+            while(own){
+                int source = popLsb(own);
+                for(int destination = 0; destination < 64; destination++){
+                    if(destination != source && cache.allows(source, destination))
+                        legal++;
+                    checked++;
+                }
+            }
+        }
+        sink = legal;
+        return checked;
+    });
+    benchmarks.emplace_back("check4checkmate", [](){
+        uint64_t mates = 0;
+        for(ChessBoard& chessBoard: checks)
+            mates += check4checkmate(&chessBoard);
+        sink = mates;
+        return uint64_t(checks.size());
+    });
+    benchmarks.emplace_back("gameStatus", [](){
+        uint64_t over = 0;
+        for(ChessBoard& chessBoard: checks)
+            over += gameStatus(&chessBoard) != STATUS_PLAYING;
+        for(ChessBoard& chessBoard: mixed)
+            over += gameStatus(&chessBoard) != STATUS_PLAYING;
+        sink = over;
+        return uint64_t(checks.size() + mixed.size());
+    });
+    benchmarks.emplace_back("printBoard", [](){
+        uint64_t length = 0;
+        for(ChessBoard& chessBoard: mixed){
+            length += boardText(WHITE, &chessBoard).size();
+            length += boardText(BLACK, &chessBoard).size();
+        }
+        sink = length;
+        return uint64_t(mixed.size() * 2);
+    });
+    benchmarks.emplace_back("generateLegalMoves", [](){
+        uint64_t moves = 0;
+        for(ChessBoard& chessBoard: mixed){
+            MoveList list;
+            generateLegalMoves(&chessBoard, list);
+            moves += list.size();
+        }
+        sink = moves;
+        return uint64_t(mixed.size());
+    });
+    benchmarks.emplace_back("makeUnmake", [](){
+        uint64_t made = 0;
+        for(ChessBoard& chessBoard: mixed){
+            MoveList list;
+            generateLegalMoves(&chessBoard, list);
+            UndoRecord undo;
+            for(Move move: list){
+                chessBoard.makeMove(move, undo);
+                chessBoard.unmakeMove(undo);
+            }
+            made += list.size();
+        }
+        return made;
+    });
+    benchmarks.emplace_back("staticExchange", [](){
+        uint64_t captures = 0;
+        int64_t total = 0;
+        for(ChessBoard& chessBoard: mixed){
+            MoveList list;
+            generateLegalMoves(&chessBoard, list, true);
+            for(Move move: list)
+                total += chessBoard.staticExchange(move);
+            captures += list.size();
+        }
+        sink = uint64_t(total);
+        return captures;
+    });
+    benchmarks.emplace_back("evaluate", [](){
+        int64_t total = 0;
+        for(ChessBoard& chessBoard: mixed)
+            total += evaluate(&chessBoard);
+        sink = uint64_t(total);
+        return uint64_t(mixed.size());
+    });
+    //Leaf nodes of a depth 3 tree below every position
+    benchmarks.emplace_back("perft", [](){
+        uint64_t nodes = 0;
+        for(ChessBoard& chessBoard: mixed)
+            nodes += perft(&chessBoard, 3);
+        return nodes;
+    });
+}
+
+static std::string jsonEscape(const std::string& text){
+    std::string escaped;
+    for(char c: text){
+        if(c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+static std::string toJson(const std::vector<BenchResult>& results){
+    std::ostringstream json;
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    json<<"{\n  \"context\": {\"date\": \""<<date<<"\", \"compiler\": \""<<jsonEscape(__VERSION__)<<"\", \"simd\": \""<<simdName(simdSupported())<<"\"},\n";
+    json<<"  \"benchmarks\": [\n";
+    for(size_t i = 0; i < results.size(); i++){
+        const BenchResult& result = results[i];
+        json<<"    {\"name\": \""<<jsonEscape(result.name)<<"\", \"operations\": "<<result.operations<<", \"seconds\": "<<result.seconds
+        <<", \"ns_per_op\": "<<result.nanosecondsPerOperation()<<"}"<<(i + 1 < results.size()? "," : "")<<"\n";
+    }
+    json<<"  ]\n}\n";
+    return json.str();
+}
+
+//Reads back the name and ns_per_op of each benchmark from a file written by toJson
+static std::map<std::string, double> readBaseline(const std::string& path){
+    std::map<std::string, double> baseline;
+    std::ifstream input(path);
+    std::string line;
+    while(std::getline(input, line)){
+        size_t name = line.find("\"name\": \""), time = line.find("\"ns_per_op\": ");
+        if(name == std::string::npos || time == std::string::npos)
+            continue;
+        name += 9;
+        baseline[line.substr(name, line.find('"', name) - name)] = atof(line.c_str() + time + 13);
+    }
+    return baseline;
+}
+
+int main(int argc, char* argv[]){
+    std::string filter, jsonPath, comparePath;
+    double minimum = 0.5, threshold = 10;
+    for(int i = 1; i < argc; i++){
+        std::string option = argv[i];
+        if(i + 1 >= argc){
+            std::cout<<"Usage: chess_bench [--filter <text>] [--time <seconds>] [--json <file>] [--compare <baseline json> [--threshold <percent>]]\n";
+            return 1;
+        }
+        if(option == "--filter")
+            filter = argv[++i];
+        else if(option == "--time")
+            minimum = atof(argv[++i]);
+        else if(option == "--json")
+            jsonPath = argv[++i];
+        else if(option == "--compare")
+            comparePath = argv[++i];
+        else if(option == "--threshold")
+            threshold = atof(argv[++i]);
+        else{
+            std::cout<<"Unknown option "<<option<<"\n";
+            return 1;
+        }
+    }
+    initBitboards();
+    initZobrist();
+    initEval();
+
+    std::map<std::string, double> baseline;
+    if(!comparePath.empty()){
+        baseline = readBaseline(comparePath);
+        if(baseline.empty()){
+            std::cout<<"Cannot read a baseline from "<<comparePath<<"\n";
+            return 1;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::function<uint64_t()>>> benchmarks;
+    defineBenchmarks(benchmarks);
+    std::vector<BenchResult> results;
+    bool regressed = false;
+    for(auto& benchmark: benchmarks){
+        if(benchmark.first.find(filter) == std::string::npos)
+            continue;
+        results.push_back(measure(benchmark.first, minimum, benchmark.second));
+        const BenchResult& result = results.back();
+        std::cout<<result.name<<"\t"<<result.nanosecondsPerOperation()<<" ns/op\t"<<uint64_t(result.operations / result.seconds)<<" op/s";
+        auto before = baseline.find(result.name);
+        if(before != baseline.end()){
+            double change = (result.nanosecondsPerOperation() / before->second - 1) * 100;
+            bool slower = change > threshold;
+            regressed = regressed || slower;
+            std::cout<<"\t"<<(change >= 0? "+" : "")<<change<<"%"<<(slower? " REGRESSION" : "");
+        }
+        std::cout<<"\n";
+    }
+    if(!jsonPath.empty()){
+        std::ofstream output(jsonPath);
+        output<<toJson(results);
+        if(!output){
+            std::cout<<"Cannot write "<<jsonPath<<"\n";
+            return 1;
+        }
+    }
+    return regressed? 1 : 0;
+}
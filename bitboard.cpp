@@ -0,0 +1,147 @@
+#include <mutex>
+#include "bitboard.h"
+
+Bitboard knightAttacks[64];
+Bitboard kingAttacks[64];
+Bitboard pawnAttacks[2][64];
+Bitboard betweenMask[64][64];
+Bitboard lineMask[64][64];
+
+Magic rookMagics[64];
+Magic bishopMagics[64];
+
+static Bitboard rookTable[0x19000];
+static Bitboard bishopTable[0x1480];
+
+static const int rookDirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+static const int bishopDirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+//Walks each direction one square at a time, stopping on (and including) the first occupied square
+static Bitboard slidingAttacks(int square, Bitboard occupied, const int dirs[4][2]){
+    Bitboard attacks = 0;
+    for(int i = 0; i < 4; i++){
+        int col = square % 8 + dirs[i][0], row = square / 8 + dirs[i][1];
+        while(0 <= col && col < 8 && 0 <= row && row < 8){
+            attacks |= squareBB(row * 8 + col);
+            if(occupied & squareBB(row * 8 + col))
+                break;
+            col += dirs[i][0];
+            row += dirs[i][1];
+        }
+    }
+    return attacks;
+}
+
+static Bitboard leaperAttacks(int square, const int offsets[][2], int count){
+    Bitboard attacks = 0;
+    for(int i = 0; i < count; i++){
+        int col = square % 8 + offsets[i][0], row = square / 8 + offsets[i][1];
+        if(0 <= col && col < 8 && 0 <= row && row < 8)
+            attacks |= squareBB(row * 8 + col);
+    }
+    return attacks;
+}
+
+//xorshift64star, seeded with a constant so the magics found are the same on every run
+static Bitboard randomSparse(Bitboard& seed){
+    Bitboard r[3];
+    for(int i = 0; i < 3; i++){
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        r[i] = seed * 2685821657736338717ULL;
+    }
+    return r[0] & r[1] & r[2];
+}
+
+//Finds a magic multiplier for every square by trial, filling the shared attack table as it goes
+static void initMagics(Magic magics[], Bitboard table[], const int dirs[4][2]){
+    Bitboard occupancies[4096], references[4096];
+    int epoch[4096] = {}, attempt = 0;
+    Bitboard seed = 0x9E3779B97F4A7C15ULL;
+    Bitboard* next = table;
+
+    for(int square = 0; square < 64; square++){
+        Magic& m = magics[square];
+        //Edge squares never block a slider, so they are left out of the relevant occupancy
+        Bitboard edges = ((RANK_1 | RANK_8) & ~(RANK_1 << (8 * (square / 8)))) | ((FILE_A | FILE_H) & ~(FILE_A << (square % 8)));
+        m.mask = slidingAttacks(square, 0, dirs) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        //Enumerate every subset of the mask with the Carry-Rippler trick
+        int size = 0;
+        Bitboard b = 0;
+        do{
+            occupancies[size] = b;
+            references[size] = slidingAttacks(square, b, dirs);
+#ifdef USE_PEXT
+            m.attacks[_pext_u64(b, m.mask)] = references[size];
+#endif
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while(b);
+        next += size;
+
+#ifndef USE_PEXT
+        bool found = false;
+        while(!found){
+            do
+                m.magic = randomSparse(seed);
+            while(popCount((m.magic * m.mask) >> 56) < 6);
+
+            attempt++;
+            found = true;
+            for(int i = 0; i < size; i++){
+                unsigned idx = m.index(occupancies[i]);
+                if(epoch[idx] < attempt){
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = references[i];
+                }
+                else if(m.attacks[idx] != references[i]){
+                    found = false;
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+static void buildTables(){
+    const int knightOffsets[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    const int kingOffsets[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    const int blackPawnOffsets[2][2] = {{-1, -1}, {1, -1}};
+    const int whitePawnOffsets[2][2] = {{-1, 1}, {1, 1}};
+    for(int square = 0; square < 64; square++){
+        knightAttacks[square] = leaperAttacks(square, knightOffsets, 8);
+        kingAttacks[square] = leaperAttacks(square, kingOffsets, 8);
+        pawnAttacks[0][square] = leaperAttacks(square, blackPawnOffsets, 2);
+        pawnAttacks[1][square] = leaperAttacks(square, whitePawnOffsets, 2);
+    }
+
+    initMagics(rookMagics, rookTable, rookDirs);
+    initMagics(bishopMagics, bishopTable, bishopDirs);
+
+    for(int from = 0; from < 64; from++){
+        for(int to = 0; to < 64; to++){
+            betweenMask[from][to] = lineMask[from][to] = 0;
+            if(from == to)
+                continue;
+            if(bishopAttacks(from, 0) & squareBB(to)){
+                betweenMask[from][to] = bishopAttacks(from, squareBB(to)) & bishopAttacks(to, squareBB(from));
+                lineMask[from][to] = (bishopAttacks(from, 0) & bishopAttacks(to, 0)) | squareBB(from) | squareBB(to);
+            }
+            else if(rookAttacks(from, 0) & squareBB(to)){
+                betweenMask[from][to] = rookAttacks(from, squareBB(to)) & rookAttacks(to, squareBB(from));
+                lineMask[from][to] = (rookAttacks(from, 0) & rookAttacks(to, 0)) | squareBB(from) | squareBB(to);
+            }
+        }
+    }
+}
+
+//Threads that call it together wait for the one building the tables
+void initBitboards(){
+    static std::once_flag built;
+    std::call_once(built, buildTables);
+}
@@ -0,0 +1,57 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
+
+//A bitboard has one bit per square, bit 0 is a1 and bit 63 is h8 (the same numbering as ChessBoard positions)
+typedef uint64_t Bitboard;
+
+const Bitboard FILE_A = 0x0101010101010101ULL;
+const Bitboard FILE_H = FILE_A << 7;
+const Bitboard RANK_1 = 0xFFULL;
+const Bitboard RANK_8 = RANK_1 << 56;
+
+//Leaper attacks, pawn attacks are indexed by color index (black, white) first
+extern Bitboard knightAttacks[64];
+extern Bitboard kingAttacks[64];
+extern Bitboard pawnAttacks[2][64];
+//Squares strictly between two squares on a shared rank, file or diagonal (empty otherwise)
+extern Bitboard betweenMask[64][64];
+//The full line through two squares on a shared rank, file or diagonal (empty otherwise)
+extern Bitboard lineMask[64][64];
+
+struct Magic{
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    int shift;
+    unsigned index(Bitboard occupied) const{
+#ifdef USE_PEXT
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+
+//Must be called before any of the tables above are used, from any thread and as often as needed
+void initBitboards();
+
+inline Bitboard squareBB(int square) {return 1ULL << square;}
+inline int popCount(Bitboard b) {return __builtin_popcountll(b);}
+inline int lsb(Bitboard b) {return __builtin_ctzll(b);}
+inline int popLsb(Bitboard& b) {int square = lsb(b); b &= b - 1; return square;}
+inline bool moreThanOne(Bitboard b) {return (b & (b - 1)) != 0;}
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {return rookMagics[square].attacks[rookMagics[square].index(occupied)];}
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {return bishopMagics[square].attacks[bishopMagics[square].index(occupied)];}
+inline Bitboard queenAttacks(int square, Bitboard occupied) {return rookAttacks(square, occupied) | bishopAttacks(square, occupied);}
+
+#endif
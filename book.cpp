@@ -0,0 +1,380 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <queue>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "book.h"
+#include "gamefile.h"
+#include "pgn.h"
+#include "fen.h"
+#include "movegen.h"
+
+//Runs are merged reading this many records of each at a time
+const size_t MERGE_BLOCK = 4096;
+
+OpeningBook::~OpeningBook(){
+    if(mapping != nullptr)
+        munmap(mapping, size);
+}
+
+bool OpeningBook::open(const std::string& path){
+    if(mapping != nullptr)
+        munmap(mapping, size);
+    mapping = nullptr;
+    entries = nullptr;
+    count = 0;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(BookHeader)){
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED)
+        return false;
+    const BookHeader* header = (const BookHeader*)mapped;
+    if(memcmp(header->magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 || sizeof(BookHeader) + header->entries * sizeof(BookEntry) > size_t(info.st_size)){
+        munmap(mapped, info.st_size);
+        return false;
+    }
+    //A lookup touches a handful of pages spread over the file, reading ahead would only fetch pages nobody wants
+    madvise(mapped, info.st_size, MADV_RANDOM);
+    mapping = mapped;
+    size = info.st_size;
+    entries = (const BookEntry*)((const char*)mapped + sizeof(BookHeader));
+    count = header->entries;
+    return true;
+}
+
+void OpeningBook::lookup(uint64_t key, const BookEntry*& first, const BookEntry*& last){
+    first = std::lower_bound(entries, entries + count, key, [](const BookEntry& entry, uint64_t key){return entry.key < key;});
+    last = first;
+    while(last < entries + count && last->key == key)
+        last++;
+}
+
+Move OpeningBook::pick(ChessBoard* chessBoard, uint64_t random){
+    const BookEntry *first, *last;
+    lookup(chessBoard->getKey(), first, last);
+    if(first == last)
+        return NO_MOVE;
+    //A different position sharing the key would have moves that are not legal here, so only legal ones count
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    uint64_t total = 0;
+    for(const BookEntry* entry = first; entry < last; entry++){
+        if(std::find(list.begin(), list.end(), entry->move) != list.end())
+            total += entry->weight;
+    }
+    if(total == 0)
+        return NO_MOVE;
+    uint64_t point = random % total;
+    for(const BookEntry* entry = first; entry < last; entry++){
+        if(std::find(list.begin(), list.end(), entry->move) == list.end())
+            continue;
+        if(point < entry->weight)
+            return entry->move;
+        point -= entry->weight;
+    }
+    return NO_MOVE;
+}
+
+//A move as gathered while building, before the weights are scaled to 16 bits
+struct BookRecord{
+    uint64_t key;
+    uint32_t weight;
+    uint32_t games;
+    Move move;
+};
+
+static bool recordBefore(const BookRecord& a, const BookRecord& b){
+    return a.key != b.key? a.key < b.key : a.move < b.move;
+}
+
+//Builds a book of any size by external sorting: moves are gathered into a buffer no larger than the memory given,
+//which is sorted and written out as a run whenever it fills up. The runs are then merged into the book in one pass.
+class BookBuilder{
+private:
+    std::string path;
+    int plies;
+    size_t capacity;
+    std::vector<BookRecord> buffer;
+    std::vector<BookRecord> game;
+    std::vector<int> turns; //Who played each move of the game
+    std::vector<std::string> runs;
+    uint64_t positions = 0;
+    bool writeRun();
+    bool writeBook(uint64_t& entries);
+public:
+    uint64_t games = 0;
+    BookBuilder(const std::string& path, int plies, size_t memory):
+    path(path), plies(plies), capacity(std::max<size_t>(memory / sizeof(BookRecord), MERGE_BLOCK)) {}
+    //Called for the first plies moves of a game
+    void addMove(ChessBoard* chessBoard, Move move);
+    //Weighs the moves of the game by its result, one of the RESULT constants of gamefile.h
+    bool endGame(int result);
+    bool finish();
+};
+
+void BookBuilder::addMove(ChessBoard* chessBoard, Move move){
+    if(int(game.size()) < plies){
+        game.push_back({chessBoard->getKey(), 0, 1, move});
+        turns.push_back(chessBoard->getTurn());
+    }
+}
+
+bool BookBuilder::endGame(int result){
+    for(size_t i = 0; i < game.size(); i++){
+        if(result == RESULT_WHITE_WINS || result == RESULT_BLACK_WINS)
+            game[i].weight = ((result == RESULT_WHITE_WINS) == (turns[i] == WHITE)? 2 : 0);
+        else
+            game[i].weight = 1; //Draws and games without a result
+        buffer.push_back(game[i]);
+    }
+    positions += game.size();
+    game.clear();
+    turns.clear();
+    games++;
+    return buffer.size() + plies <= capacity || writeRun();
+}
+
+//Equal moves of a position next to each other in a sorted run are merged into one record before it is written
+bool BookBuilder::writeRun(){
+    std::sort(buffer.begin(), buffer.end(), recordBefore);
+    size_t kept = 0;
+    for(size_t i = 0; i < buffer.size(); i++){
+        if(kept > 0 && buffer[kept - 1].key == buffer[i].key && buffer[kept - 1].move == buffer[i].move){
+            buffer[kept - 1].weight += buffer[i].weight;
+            buffer[kept - 1].games += buffer[i].games;
+        }
+        else
+            buffer[kept++] = buffer[i];
+    }
+    std::string run = path + ".run" + std::to_string(runs.size());
+    std::ofstream file(run, std::ios::binary | std::ios::trunc);
+    file.write((const char*)buffer.data(), kept * sizeof(BookRecord));
+    if(!file)
+        return false;
+    runs.push_back(run);
+    buffer.clear();
+    return true;
+}
+
+//Reads one run a block at a time
+struct RunReader{
+    std::ifstream file;
+    std::vector<BookRecord> block;
+    size_t at = 0;
+    bool next(BookRecord& record){
+        if(at == block.size()){
+            block.resize(MERGE_BLOCK);
+            file.read((char*)block.data(), MERGE_BLOCK * sizeof(BookRecord));
+            block.resize(file.gcount() / sizeof(BookRecord));
+            at = 0;
+            if(block.empty())
+                return false;
+        }
+        record = block[at++];
+        return true;
+    }
+};
+
+//Merges the runs and writes the moves of each position with their weights scaled so the largest fits in 16 bits
+bool BookBuilder::writeBook(uint64_t& entries){
+    std::vector<std::unique_ptr<RunReader>> readers;
+    //The smallest record on top, with the run it came from
+    auto later = [](const std::pair<BookRecord, size_t>& a, const std::pair<BookRecord, size_t>& b){return recordBefore(b.first, a.first);};
+    std::priority_queue<std::pair<BookRecord, size_t>, std::vector<std::pair<BookRecord, size_t>>, decltype(later)> heads(later);
+    for(const std::string& run: runs){
+        readers.emplace_back(new RunReader());
+        readers.back()->file.open(run, std::ios::binary);
+        BookRecord record;
+        if(readers.back()->next(record))
+            heads.push({record, readers.size() - 1});
+    }
+
+    std::ofstream file(path + ".tmp", std::ios::binary | std::ios::trunc);
+    BookHeader header = {};
+    memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    file.write((const char*)&header, sizeof(header));
+    std::vector<BookRecord> position;
+    auto writePosition = [&]{
+        uint32_t most = 0;
+        for(const BookRecord& record: position)
+            most = std::max(most, record.weight);
+        for(const BookRecord& record: position){
+            uint32_t weight = (most > 0xFFFF? uint32_t(uint64_t(record.weight) * 0xFFFF / most) : record.weight);
+            BookEntry entry = {record.key, record.move, uint16_t(weight), record.games};
+            file.write((const char*)&entry, sizeof(entry));
+        }
+        entries += position.size();
+        position.clear();
+    };
+    entries = 0;
+    while(!heads.empty()){
+        std::pair<BookRecord, size_t> head = heads.top();
+        heads.pop();
+        BookRecord next;
+        if(readers[head.second]->next(next))
+            heads.push({next, head.second});
+        BookRecord& record = head.first;
+        if(!position.empty() && position.back().key != record.key)
+            writePosition();
+        if(!position.empty() && position.back().move == record.move){
+            position.back().weight += record.weight;
+            position.back().games += record.games;
+        }
+        else
+            position.push_back(record);
+    }
+    writePosition();
+    header.entries = entries;
+    file.seekp(0);
+    file.write((const char*)&header, sizeof(header));
+    file.close();
+    return bool(file) && rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+bool BookBuilder::finish(){
+    bool written = (buffer.empty() && !runs.empty()) || writeRun();
+    uint64_t entries = 0;
+    written = written && writeBook(entries);
+    for(const std::string& run: runs)
+        remove(run.c_str());
+    if(written)
+        std::cout<<games<<" games, "<<positions<<" positions gathered in "<<runs.size()<<" sorted runs, "<<entries<<" book entries\n";
+    return written;
+}
+
+static int resultFromPgn(const std::string& outcome){
+    if(outcome == "1-0")
+        return RESULT_WHITE_WINS;
+    if(outcome == "0-1")
+        return RESULT_BLACK_WINS;
+    if(outcome == "1/2-1/2")
+        return RESULT_DRAW;
+    return RESULT_UNFINISHED;
+}
+
+//Games from a binary game file are replayed as stored, a PGN file is read through a memory mapping like "chess pgn"
+//does. Games with an illegal move only count up to that move, and stored games whose start cannot be read not at all.
+static bool gatherGames(const std::string& input, BookBuilder& builder){
+    GameArchive archive;
+    if(archive.open(input)){
+        ChessBoard chessBoard;
+        UndoRecord undo;
+        for(size_t game = 0; game < archive.gameCount(); game++){
+            if(!archive.replay(game, 0, &chessBoard))
+                continue;
+            for(int ply = 0; ply < archive.plies(game); ply++){
+                Move move = archive.move(game, ply);
+                if(!isLegalMove(&chessBoard, move))
+                    break;
+                builder.addMove(&chessBoard, move);
+                chessBoard.makeMove(move, undo);
+            }
+            if(!builder.endGame(archive.result(game)))
+                return false;
+        }
+        return true;
+    }
+
+    int fd = open(input.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0){
+        std::cout<<"Cannot open "<<input<<"\n";
+        return false;
+    }
+    size_t size = info.st_size;
+    const char* data = nullptr;
+    if(size > 0){
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            close(fd);
+            return false;
+        }
+        data = (const char*)mapping;
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    std::string_view text(data, size);
+    size_t offset = 0;
+    bool written = true;
+    while(written && offset < text.size()){
+        std::string_view game = nextPgnGame(text, offset);
+        if(game.find_first_not_of(" \t\r\n") == std::string_view::npos)
+            continue;
+        GameResult result = replayGame(game, [&builder](ChessBoard* chessBoard, Move move){builder.addMove(chessBoard, move);});
+        written = builder.endGame(resultFromPgn(result.outcome));
+    }
+    if(data != nullptr)
+        munmap((void*)data, size);
+    return written;
+}
+
+static int buildCommand(int argc, char* argv[]){
+    int plies = (argc > 5? atoi(argv[5]) : 24);
+    size_t memory = size_t(argc > 6? atol(argv[6]) : 256) << 20;
+    BookBuilder builder(argv[3], plies > 0? plies : 24, memory);
+    auto start = std::chrono::steady_clock::now();
+    if(!gatherGames(argv[4], builder) || !builder.finish()){
+        std::cout<<"Cannot build "<<argv[3]<<"\n";
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout<<seconds<<" s\n";
+    return 0;
+}
+
+static int probeCommand(int argc, char* argv[]){
+    OpeningBook book;
+    if(!book.open(argv[3])){
+        std::cout<<"Cannot read a book from "<<argv[3]<<"\n";
+        return 1;
+    }
+    ChessBoard chessBoard;
+    std::string fen;
+    for(int i = 4; i < argc; i++)
+        fen += std::string(i > 4? " " : "") + argv[i];
+    if(fen.empty() || fen == "startpos")
+        newGame(&chessBoard);
+    else if(!setupPosition(&chessBoard, fen)){
+        std::cout<<"Invalid FEN\n";
+        return 1;
+    }
+    const BookEntry *first, *last;
+    book.lookup(chessBoard.getKey(), first, last);
+    uint64_t total = 0;
+    for(const BookEntry* entry = first; entry < last; entry++)
+        total += entry->weight;
+    std::cout<<book.entryCount()<<" entries, "<<last - first<<" for this position\n";
+    for(const BookEntry* entry = first; entry < last; entry++){
+        std::cout<<moveToString(entry->move)<<"\tweight "<<entry->weight<<"\tgames "<<entry->games
+        <<"\t"<<(total > 0? entry->weight * 100 / total : 0)<<"%\n";
+    }
+    return 0;
+}
+
+int bookCommand(int argc, char* argv[]){
+    if(argc > 4 && std::string(argv[2]) == "build")
+        return buildCommand(argc, argv);
+    if(argc > 3 && std::string(argv[2]) == "probe")
+        return probeCommand(argc, argv);
+    std::cout<<"Usage: chess book build <book> <pgn or game file> [plies] [memory MB]\n"
+    <<"       chess book probe <book> [fen]\n";
+    return 1;
+}
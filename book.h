@@ -0,0 +1,51 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <cstdint>
+#include <string>
+#include "chess.h"
+
+//An opening book is BOOK_MAGIC and the number of entries, followed by the entries sorted by position key and then move.
+//The layout of an entry follows Polyglot books, but the keys are this program's Zobrist keys in native byte order.
+const char BOOK_MAGIC[8] = {'C', 'H', 'S', 'B', 'O', 'O', 'K', '1'};
+
+struct BookHeader{
+    char magic[8];
+    uint64_t entries;
+};
+
+struct BookEntry{
+    uint64_t key;
+    Move move;
+    //Two points for every game the side playing the move won and one for every draw, scaled down to fit when needed
+    uint16_t weight;
+    uint32_t games;
+};
+
+//A read-only view of a memory-mapped book. Nothing is read when it opens: every lookup is a binary search
+//over the mapped entries, which only touches the pages it needs.
+class OpeningBook{
+private:
+    const BookEntry* entries = nullptr;
+    size_t count = 0;
+    void* mapping = nullptr;
+    size_t size = 0;
+public:
+    OpeningBook() {}
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+    ~OpeningBook();
+    //Returns false if the file cannot be mapped or is not a book, replacing any book open before
+    bool open(const std::string& path);
+    bool isOpen() {return mapping != nullptr;}
+    size_t entryCount() {return count;}
+    //The entries of a position, first is equal to last when it is not in the book
+    void lookup(uint64_t key, const BookEntry*& first, const BookEntry*& last);
+    //A legal book move for the position chosen in proportion to the weights, using random to pick, or NO_MOVE
+    Move pick(ChessBoard* chessBoard, uint64_t random);
+};
+
+//Entry point for "chess book build <book> <pgn or game file> [plies] [memory MB]" and "chess book probe <book> <fen>"
+int bookCommand(int argc, char* argv[]);
+
+#endif
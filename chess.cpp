@@ -1,599 +1,596 @@
-#include <iostream>
-#include <string>
-#include <cmath>
-
-//-1 and 1 are used instead of 0 and 1 to denote direction across the board
-const int BLACK = -1;
-const int WHITE = 1;
-
-class ChessBoard;
-class King;
-void newGame(ChessBoard* chessBoard);
-bool onBoard(std::string location);
-bool onBoard(int position);
-bool check4checkmate(ChessBoard* chessBoard, King* atRisk);
-void printBoard(int turn, ChessBoard* chessBoard);
-
-class chessPiece{
-protected:
-    std::string name;
-    int color;
-    int position;
-    bool hasMoved = false;
-public:
-    chessPiece(std::string name, std::string coord);
-    chessPiece(const chessPiece& piece): name(piece.name), color(piece.color), position(piece.position) {}
-    std::string getName() {return name;}
-    int getColor() {return color;}
-    int getPos() {return position;}
-    void setPos(int pos) {position = pos;}
-    bool getHasMoved() {return hasMoved;}
-    void setHasMoved(bool move) {hasMoved = move;}
-    //Move makes sure a move is theoretically legal for any piece (i.e starts and ends on the board and doesn't attack it's own color, etc.) and performs the movement
-    virtual bool move(ChessBoard* chessBoard, int destination, int& turn);
-    //isLegal makes sure that a move is legal for that piece (i.e. the destination is legal for that piece in that position)
-    virtual bool isLegal(int destination, ChessBoard* chessBoard) =0;
-    virtual bool isPathClear(chessPiece* board[], int destination);
-};
-
-class King: public chessPiece{
-public:
-    King(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    King(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool move(ChessBoard* chessBoard, int destination, int& turn);
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-};
-
-class Queen: public chessPiece{
-public:
-    Queen(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    Queen(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-};
-
-class Rook: public chessPiece{
-public:
-    Rook(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    Rook(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-};
-
-class Bishop: public chessPiece{
-public:
-    Bishop(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    Bishop(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-};
-
-class Knight: public chessPiece{
-public:
-    Knight(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    Knight(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-};
-
-class Pawn: public chessPiece{
-public:
-    Pawn(std::string name, std::string coord): chessPiece::chessPiece(name, coord) {}
-    Pawn(const chessPiece& piece): chessPiece::chessPiece(piece) {}
-    virtual bool isLegal(int destination, ChessBoard* chessBoard);
-    virtual bool move(ChessBoard* chessBoard, int destination, int& turn);
-    virtual bool isPathClear(chessPiece* board[], int destination);
-    void promote(ChessBoard* chessBoard);
-};
-
-class ChessBoard{
-private:
-    chessPiece* board[64] {};
-    King* kings[2]; //black and white kings in that order
-    int movements[32][1];
-    Pawn* enpassantable = nullptr;
-public:
-    ChessBoard() {}
-    void addPiece(chessPiece* newPiece) {board[newPiece->getPos()] = newPiece;}
-    chessPiece** getBoard() {return board;}
-    King** getKings() {return kings;}
-    Pawn* getEnpassantable() {return enpassantable;}
-    void setEnpassantable(Pawn* piece) {enpassantable = piece;}
-    chessPiece* isThreatened(int position, int color, bool includeKings = true);
-    chessPiece* isThreatened(chessPiece* piece);
-    friend class chessPiece;
-    friend class King;
-    friend class Queen;
-    friend class Rook;
-    friend class Bishop;
-    friend class Knight;
-    friend class Pawn;
-};
-
-chessPiece::chessPiece(std::string name, std::string coord): name(name){
-    if('a' <= name[0] && name[0] <= 'z')
-        color = BLACK;
-    else if('A' <= name[0] && name[0] <= 'Z')
-        color = WHITE;
-    position = coord[0] - 'a' + ((coord[1] - '0') - 1) * 8;
-}
-
-bool chessPiece::isPathClear(chessPiece* board[], int destination){
-    int tempPos = position, colDir, rowDir;
-    colDir = (position % 8 != destination % 8? (destination % 8 - position % 8) / abs(destination % 8 - position % 8): 0);
-    rowDir = (position / 8 != destination / 8? (destination / 8 - position / 8) / abs(destination / 8 - position / 8): 0);
-    
-    while (tempPos + (8 * rowDir) + (colDir) != destination){
-        tempPos += (8 * rowDir + colDir);
-        if(board[tempPos] != nullptr)
-            return false;
-    }
-    return true;
-}
-
-bool chessPiece::move(ChessBoard* chessBoard, int destination, int& turn){
-    chessPiece** positions = chessBoard->getBoard();
-    King** kings = chessBoard->getKings();
-    if(color != turn){
-        std::cout<<"It is "<<(turn == WHITE? "white's " : "black's ")<<"turn\n";
-        return false;
-    }
-
-    if(positions[destination] != nullptr){
-        if(positions[destination]->color == color){
-            std::cout<<"You cannot attack your own piece\n";
-            return false;
-        }
-    }
-    
-    if(name[1] != 'n' && name[1] != 'N'){
-        if(!isPathClear(positions, destination)){
-            std::cout<<"Not a legal move\n";
-            return false;
-        }
-    }
-
-    if(!isLegal(destination, chessBoard)){
-        std::cout<<"Not a legal move\n";
-        return false;
-    }
-
-    //Test if the move places your own king in check
-    chessPiece* temp = positions[destination];
-    positions[destination] = this;
-    positions[position] = nullptr;
-    if(chessBoard->isThreatened(kings[int(0.5 * turn + 0.5)])){
-        std::cout<<"You cannot put your own king in check.\n";
-        positions[position] = this; //undo the illegal move
-        positions[destination] = temp;
-        return false;
-    }
-
-    delete temp;
-    positions[destination] = this;
-
-    position = destination;
-    chessBoard->enpassantable = nullptr;
-    hasMoved = true;
-    return true;
-}
-
-chessPiece* ChessBoard::isThreatened(chessPiece* piece){return isThreatened(piece->getPos(), piece->getColor() * -1);}
-
-chessPiece* ChessBoard::isThreatened(int position, int threatColor, bool includeKings){
-    int knPosArr[8] = {-17, -15, -10, -6, 6, 10, 15, 17};
-    int dirs[8] = {-9, -8, -7, -1, 1, 7, 8, 9};
-    int knPos, dir, offset; 
-    for(int i = 0; i < 8; i++){
-        //Check Knight Positions
-        knPos = knPosArr[i];
-        if(onBoard(position + knPos)){
-            if(board[position + knPos] != nullptr){
-                if(board[position + knPos]->getColor() == threatColor && board[position + knPos]->isLegal(position, this))
-                    return board[position + knPos];
-            }
-        }
-        //Check rank, file, and diagonal positions
-        dir = dirs[i];
-        offset = dir;
-        while(onBoard(position + dir)){
-            if(board[position + dir] != nullptr){
-                if(board[position + dir]->getColor() == threatColor && board[position + dir]->isLegal(position, this))
-                    if(includeKings)
-                        return board[position + dir];
-                    else
-                        break;
-                break;
-            }
-            dir += offset;
-        }
-    }
-    return nullptr;
-}
-
-bool Knight::isLegal(int destination, ChessBoard* chessBoard){
-    if(abs(destination % 8 - position % 8) == 2 && abs(destination / 8 - position / 8) == 1 ||
-    abs(destination % 8 - position % 8) == 1 && abs(destination / 8 - position / 8) == 2)
-        return true;
-    return false;
-}
-
-bool Bishop::isLegal(int destination, ChessBoard* chessBoard){
-    if(abs(destination % 8 - position % 8) == abs(destination / 8 - position / 8))
-        return true;
-    return false;
-}
-
-bool Rook::isLegal(int destination, ChessBoard* chessBoard){
-    if(destination % 8 - position % 8 == 0 || destination / 8 - position / 8 == 0){
-        return true;
-    }
-    return false;
-}
-
-bool Queen::isLegal(int destination, ChessBoard* chessBoard){
-    if(destination % 8 - position % 8 == 0 || destination / 8 - position / 8 == 0 || abs(destination % 8 - position % 8) == abs(destination / 8 - position / 8))
-        return true;
-    return false;
-}
-
-bool King::move(ChessBoard* chessBoard, int destination, int& turn){
-    chessPiece** positions = chessBoard->getBoard();
-    King** kings = chessBoard->getKings();
-    if(color != turn){
-        std::cout<<"It is "<<(turn == WHITE? "white's " : "black's ")<<"turn\n";
-        return false;
-    }
-
-    if(positions[destination] != nullptr){
-        if(positions[destination]->getColor() == color){
-            std::cout<<"You cannot attack your own piece\n";
-            return false;
-        }
-    }
-
-    if(!isLegal(destination, chessBoard)){
-        std::cout<<"Not a legal move\n";
-        return false;
-    }
-
-    //Check if the move endangers the king
-    chessPiece* temp = positions[destination];
-    positions[destination] = this;
-    positions[position] = nullptr;
-    if(chessBoard->isThreatened(destination, color * -1)){
-        std::cout<<"You cannot put your own king in check.\n";
-        positions[position] = this; //undo the illegal move
-        positions[destination] = temp;
-        return false;
-    }
-
-    delete temp;
-    positions[destination] = this;
-
-    position = destination;
-    chessBoard->enpassantable = nullptr;
-    hasMoved = true;
-
-    //When castling, deal with the castle's movement
-    if(abs(destination - position) == 2){
-        int moveDir = (destination > position? 1 : -1);
-        int castlePos = (destination > position? position + 3 : position - 4);
-        positions[position + moveDir] = positions[castlePos];
-        positions[castlePos]->setHasMoved(true);
-        positions[castlePos]->setPos(position + moveDir);
-        positions[castlePos] = nullptr;
-    }
-    return true;
-}
-
-bool King::isLegal(int destination, ChessBoard* chessBoard){
-    if(abs(destination % 8 - position % 8) == 1 || abs(destination / 8 - position / 8) == 1){
-        return true;
-    }
-    else if((destination % 8 == 6 || destination % 8 == 2) && !hasMoved){ //castling
-        chessPiece** board = chessBoard->board;
-        int castlePos = (destination % 8 == 6? position + 3 : position - 4);
-        if(board[castlePos]->getHasMoved())
-            return false;
-        if(!isPathClear(board, castlePos))
-            return false;
-        int moveDir = (destination % 8 == 6? 1 : -1);
-        for(int i = 0; i <= 2; i++){
-            if(chessBoard->isThreatened(position + i * moveDir, color * -1))
-                return false;
-        }
-        return true;
-    }
-    return false;
-}
-
-//When not attacking, pawn needs every square including the one it lands on to be clear
-bool Pawn::isPathClear(chessPiece* board[], int destination){
-    int tempPos = position + 8 * color;
-    while((destination - tempPos) * color >= 0){ //Until destination has been checked
-        if(board[tempPos] != nullptr)
-            return false;
-        tempPos += 8 * color;
-    }
-    return true;
-}
-
-bool Pawn::move(ChessBoard* chessBoard, int destination, int& turn){
-    chessPiece** positions = chessBoard->getBoard();
-    King** kings = chessBoard->getKings();
-    if(color != turn){
-        std::cout<<"It is "<<(turn == WHITE? "white's " : "black's ")<<"turn\n";
-        return false;
-    }
-
-    if(positions[destination] != nullptr){
-        if(positions[destination]->getColor() == color){
-            std::cout<<"You cannot attack your own piece\n";
-            return false;
-        }
-    }
-
-    if(!isLegal(destination, chessBoard)){
-        std::cout<<"Not a legal move\n";
-        return false;
-    }   
-    
-    //Requiring a clear path is only relevant for pawns when not attacking
-    //Becasue pawns can't skip squares while attacking
-    if(position % 8 == destination % 8){
-        if(!isPathClear(positions, destination)){
-            std::cout<<"Not a legal move\n";
-            return false;
-        }
-    }
-
-    if(destination / 8 == color * 2 + position / 8)
-        chessBoard->enpassantable = this;
-    else
-        chessBoard->enpassantable = nullptr;
-
-    chessPiece* temp = positions[destination];
-    positions[destination] = this;
-    positions[position] = nullptr;
-    if(chessBoard->isThreatened(kings[int(0.5 * turn + 0.5)])){
-        std::cout<<"You cannot put your own king in check.\n";
-        positions[position] = this; //undo the illegal move
-        positions[destination] = temp;
-        return false;
-    }
-    delete temp;
-    position = destination;
-
-    if(destination / 8 == 0 || destination / 8 == 7)
-        promote(chessBoard);
-    return true;
-}
-
-bool Pawn::isLegal(int destination, ChessBoard* chessBoard){
-    chessPiece** board = chessBoard->board;
-    if(destination == 8 * color + position){ //Normal movement
-        hasMoved = true;
-        return true;
-    }
-    else if(hasMoved == false && destination / 8 == color * 2 + position / 8){ //Double move
-        hasMoved = true;
-        return true;
-    }
-    else if(destination / 8 == color + position / 8 && abs(destination % 8 - position % 8) == 1 && board[destination] != nullptr){ //Normal attack
-        hasMoved = true;
-        return true;
-    }
-    else if((destination / 8 == color + position / 8) && (abs(destination % 8 - position % 8) == 1) 
-    && (board[destination + 8 * -1 * color] != nullptr) && (chessBoard->enpassantable == board[destination + 8 * -1 * color])){ //En passant
-        delete board[destination + 8 * -1 * color];
-        board[destination + 8 * -1 * color] = nullptr;
-        return true;
-    }
-    return false;
-}
-
-void Pawn::promote(ChessBoard* chessBoard){
-    char selection;
-    std::cout<<"Select one to promote your pawn to: Queen(Q), Rook(R), Bishop(B), Knight(N)\n";
-    std::cin>>selection;
-    Pawn* temp = this;
-
-    char row = (position / 8) + '0' + 1;
-    char column = (position % 8) + 'a';
-    std::string coord;
-    coord += column;
-    coord += row;
-    std::string newName;
-    newName += name[0];
-    
-    switch (selection){
-    case 'Q':
-        chessBoard->board[position] = new Queen(newName + "Q", coord);
-        delete temp;
-        break;
-    case 'R':
-        chessBoard->board[position] = new Rook(newName + "R", coord);
-        delete temp;
-        break;
-    case 'B':
-        chessBoard->board[position] = new Bishop(newName + "B", coord);
-        delete temp;
-        break;
-    case 'N':
-        chessBoard->board[position] = new Knight(newName + "N", coord);
-        delete temp;
-        break;
-    default:
-        std::cout<<"Invalid input\n";
-        promote(chessBoard);
-        return;
-    }
-    return;
-}
-
-int main()
-{
-    std::cout<<"Welcome to chess!\n"
-    <<"Pieces other than pawns are represented with two letters. The first is either q or k, indicating if it started on the queen or king side of the board.\n"
-    <<"Uppercase first letters represent white's pieces, lowercase black's.\n"
-    <<"The second letter is one of the following: R, N, B, Q, or K for rook, knight, bishop, queen and king respectively.\n"
-    <<"Pawns are represented as P1 - P8 using the same capitalization scheme, or p followed by the letter representing the new piece following promotion.\n"
-    <<"To move, enter the position of the piece you want to move, e.g. b5, using lowercase letters"
-    <<" followed after a space by the position you want the piece to move to.\n"
-    <<"As an example, white might make the opening move e2 e4.\n"
-    <<"Castling is indicated from the king's point of view.\n"
-    <<"Stalemates are not implemented.\n";
-    int turn = WHITE;
-    ChessBoard* chessBoard = new ChessBoard();
-    std::string src, dest;
-    newGame(chessBoard);
-    while(true){
-        printBoard(turn, chessBoard);
-        std::cin>>src>>dest;
-        int srcPos = src[0] - 'a' + ((src[1] - '0') - 1) * 8;
-        int destPos = dest[0] - 'a' + ((dest[1] - '0') - 1) * 8;
-        if(!onBoard(src) || !onBoard(dest)){
-            std::cout<<"Invalid address entered\n";
-            continue;
-        }
-        if(srcPos == destPos || chessBoard->getBoard()[srcPos] == nullptr){
-            std::cout<<"A piece must move every turn\n";
-            continue;
-        }
-        if(!chessBoard->getBoard()[srcPos]->move(chessBoard, destPos, turn))
-            continue;
-        if(check4checkmate(chessBoard, chessBoard->getKings()[int(-0.5 * turn + 0.5)])){
-            std::cout<<(turn == WHITE? "WHITE" : "BLACK")<<" WINS!\n";
-            break;
-        }
-        turn = turn * -1;
-    }
-    return 0;
-}
-
-void newGame(ChessBoard* chessBoard){
-    Rook* QR = new Rook("QR", "a1");
-    chessBoard->addPiece(QR);
-    Knight* QN = new Knight("QN", "b1");
-    chessBoard->addPiece(QN);
-    Bishop* QB = new Bishop("QB", "c1");
-    chessBoard->addPiece(QB);
-    Queen* QQ = new Queen("QQ", "d1");
-    chessBoard->addPiece(QQ);
-    King* KK = new King("KK", "e1");
-    chessBoard->addPiece(KK);
-    Bishop* KB = new Bishop("KB", "f1");
-    chessBoard->addPiece(KB);
-    Knight* KN = new Knight("KN", "g1");
-    chessBoard->addPiece(KN);
-    Rook* KR = new Rook("KR", "h1");
-    chessBoard->addPiece(KR);
-    Pawn* P1 = new Pawn("P1", "a2");
-    chessBoard->addPiece(P1);
-    Pawn* P2 = new Pawn("P2", "b2");
-    chessBoard->addPiece(P2);
-    Pawn* P3 = new Pawn("P3", "c2");
-    chessBoard->addPiece(P3);
-    Pawn* P4 = new Pawn("P4", "d2");
-    chessBoard->addPiece(P4);
-    Pawn* P5 = new Pawn("P5", "e2");
-    chessBoard->addPiece(P5);
-    Pawn* P6 = new Pawn("P6", "f2");
-    chessBoard->addPiece(P6);
-    Pawn* P7 = new Pawn("P7", "g2");
-    chessBoard->addPiece(P7);
-    Pawn* P8 = new Pawn("P8", "h2");
-    chessBoard->addPiece(P8);
-    
-    Rook* qR = new Rook("qR", "a8");
-    chessBoard->addPiece(qR);
-    Knight* qN = new Knight("qN", "b8");
-    chessBoard->addPiece(qN);
-    Bishop* qB = new Bishop("qB", "c8");
-    chessBoard->addPiece(qB);
-    Queen* qQ = new Queen("qQ", "d8");
-    chessBoard->addPiece(qQ);
-    King* kK = new King("kK", "e8");
-    chessBoard->addPiece(kK);
-    Bishop* kB = new Bishop("kB", "f8");
-    chessBoard->addPiece(kB);
-    Knight* kN = new Knight("kN", "g8");
-    chessBoard->addPiece(kN);
-    Rook* kR = new Rook("kR", "h8");
-    chessBoard->addPiece(kR);
-    Pawn* p1 = new Pawn("p1", "a7");
-    chessBoard->addPiece(p1);
-    Pawn* p2 = new Pawn("p2", "b7");
-    chessBoard->addPiece(p2);
-    Pawn* p3 = new Pawn("p3", "c7");
-    chessBoard->addPiece(p3);
-    Pawn* p4 = new Pawn("p4", "d7");
-    chessBoard->addPiece(p4);
-    Pawn* p5 = new Pawn("p5", "e7");
-    chessBoard->addPiece(p5);
-    Pawn* p6 = new Pawn("p6", "f7");
-    chessBoard->addPiece(p6);
-    Pawn* p7 = new Pawn("p7", "g7");
-    chessBoard->addPiece(p7);
-    Pawn* p8 = new Pawn("p8", "h7");
-    chessBoard->addPiece(p8);
-    
-    chessBoard->getKings()[0] = kK;
-    chessBoard->getKings()[1] = KK;
-}
-
-bool onBoard(std::string location){
-    if('a' <= location[0] && location[0] <= 'h' && '1' <= location[1] && location[1] <= '8' && location.length() == 2)
-        return true;
-    return false;
-}
-
-bool onBoard(int position){
-    if(0 <= position && position <= 63)
-        return true;
-    return false;
-}
-
-bool check4checkmate(ChessBoard* chessBoard, King* atRisk){
-    chessPiece** board = chessBoard->getBoard();
-    chessPiece* threatening = chessBoard->isThreatened(atRisk);
-    if(!threatening)
-        return false;
-    int surroundings[8] = {-9, -8, -7 ,-1, 1, 7, 8, 9};
-    for(int dir: surroundings){
-        int check = atRisk->getPos() + dir;
-        if(onBoard(check)){
-            if((board[check] == nullptr || board[check]->getColor() != atRisk->getColor()) && !chessBoard->isThreatened(check, atRisk->getColor() * -1))
-                return false;
-        }
-    }
-    int tempPos = atRisk->getPos(), colDir, rowDir;
-    colDir = (tempPos % 8 != threatening->getPos() % 8? (threatening->getPos() % 8 - tempPos % 8) / abs(threatening->getPos() % 8 - tempPos % 8): 0);
-    rowDir = (tempPos / 8 != threatening->getPos() / 8? (threatening->getPos() / 8 - tempPos / 8) / abs(threatening->getPos() / 8 - tempPos / 8): 0);
-    while (board[tempPos] != threatening){
-        tempPos += (8 * rowDir + colDir);
-        if(chessBoard->isThreatened(tempPos, atRisk->getColor(), false))
-            return false;
-    }
-    return true;
-}
-
-void printBoard(int turn, ChessBoard* chessBoard){
-    std::cout<<std::endl;
-    for(char letter = -3.5 * turn + 100.5; 'a' <= letter && letter <= 'h'; letter += turn)
-        std::cout<<"\t"<<letter;
-        std::cout<<std::endl;
-
-    for(int i = 3.5 * turn + 4.5; 1 <= i && i <= 8; i += turn * -1){
-        std::cout<<i<<"\t";
-        for(int j = 8 * i - (3.5 * turn + 4.5); 8 * (i - 1) <= j && j < 8 * i; j += turn){
-            if(chessBoard->getBoard()[j] != nullptr)
-                std::cout<<chessBoard->getBoard()[j]->getName()<<"\t";
-            else
-                std::cout<<"--\t";
-        }
-        std::cout<<i<<std::endl;
-    }
-
-    for(char letter = -3.5 * turn + 100.5; letter >= 'a' && letter <= 'h'; letter += turn)
-        std::cout<<"\t"<<letter;
-    std::cout<<std::endl;
-    return;
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include "chess.h"
+#include "movegen.h"
+#include "zobrist.h"
+#include "eval.h"
+#include "nnue.h"
+
+//The checks every piece shares, followed by the rules of its own type
+template<class PieceClass> static const char* tryMove(ChessBoard* chessBoard, int source, int destination, int turn, Move& move){
+    Piece* positions = chessBoard->getBoard();
+    if(pieceColor(positions[source]) != turn)
+        return turn == WHITE? "It is white's turn" : "It is black's turn";
+
+    if(positions[destination] != NO_PIECE){
+        if(pieceColor(positions[destination]) == turn)
+            return "You cannot attack your own piece";
+    }
+
+    if(!PieceClass::isLegal(chessBoard, source, destination))
+        return "Not a legal move";
+
+    //Test if the move places your own king in check
+    move = PieceClass::encode(chessBoard, source, destination);
+    UndoRecord undo;
+    chessBoard->makeMove(move, undo);
+    bool exposed = chessBoard->isThreatened(chessBoard->kingSquare(turn), turn * -1);
+    chessBoard->unmakeMove(undo);
+    return exposed? "You cannot put your own king in check." : nullptr;
+}
+
+const char* checkMove(ChessBoard* chessBoard, int source, int destination, int turn, Move& move){
+    STAT_SAMPLED_TIMER(STAT_MOVE_VALIDATION, STAT_LEGALITY_CHECKS);
+    switch(pieceType(chessBoard->getBoard()[source])){
+    case PAWN: return tryMove<Pawn>(chessBoard, source, destination, turn, move);
+    case KNIGHT: return tryMove<Knight>(chessBoard, source, destination, turn, move);
+    case BISHOP: return tryMove<Bishop>(chessBoard, source, destination, turn, move);
+    case ROOK: return tryMove<Rook>(chessBoard, source, destination, turn, move);
+    case QUEEN: return tryMove<Queen>(chessBoard, source, destination, turn, move);
+    default: return tryMove<King>(chessBoard, source, destination, turn, move);
+    }
+}
+
+static std::string squareName(int position){
+    return std::string(1, char('a' + position % 8)) + char('1' + position / 8);
+}
+
+std::string moveHint(int source, LegalMoveCache& legal){
+    Bitboard destinations = legal.from(source);
+    if(!destinations)
+        return "The piece on " + squareName(source) + " has no legal move";
+    std::string hint = "Legal moves from " + squareName(source) + ":";
+    while(destinations)
+        hint += " " + squareName(popLsb(destinations));
+    return hint;
+}
+
+bool playMove(ChessBoard* chessBoard, int source, int destination, int turn, LegalMoveCache& legal, Move* played){
+    legal.update(chessBoard);
+    if(!legal.allows(source, destination)){
+        Move move;
+        const char* problem = checkMove(chessBoard, source, destination, turn, move);
+        std::cout<<(problem != nullptr? problem : "Not a legal move")<<"\n";
+        if(pieceColor(chessBoard->getBoard()[source]) == turn)
+            std::cout<<moveHint(source, legal)<<"\n";
+        return false;
+    }
+    //Refused moves are counted and timed by checkMove above, accepted ones by the lookup here
+    Move move;
+    {
+        STAT_SAMPLED_TIMER(STAT_MOVE_VALIDATION, STAT_LEGALITY_CHECKS);
+        move = legal.find(source, destination);
+    }
+    if(isPromotion(move))
+        move = legal.find(source, destination, Pawn::promote());
+    UndoRecord undo;
+    chessBoard->makeMove(move, undo);
+    if(played != nullptr)
+        *played = move;
+    return true;
+}
+
+bool playMove(ChessBoard* chessBoard, int source, int destination, int turn, Move* played){
+    Move move;
+    const char* problem = checkMove(chessBoard, source, destination, turn, move);
+    if(problem != nullptr){
+        std::cout<<problem<<"\n";
+        return false;
+    }
+    if(isPromotion(move))
+        move = encodeMove(source, destination, MOVE_PROMOTION + Pawn::promote() - KNIGHT);
+    UndoRecord undo;
+    chessBoard->makeMove(move, undo);
+    if(played != nullptr)
+        *played = move;
+    return true;
+}
+
+void ChessBoard::addPiece(Piece piece, int position){
+    board[position] = piece;
+    pieceSquareScore[MIDGAME] += pieceSquare[MIDGAME][piece][position];
+    pieceSquareScore[ENDGAME] += pieceSquare[ENDGAME][piece][position];
+    pieces[colorIndex(pieceColor(piece))][pieceType(piece)] |= squareBB(position);
+    colorPieces[colorIndex(pieceColor(piece))] |= squareBB(position);
+    occupancy |= squareBB(position);
+}
+
+Piece ChessBoard::removePiece(int position){
+    Piece removed = board[position];
+    if(removed == NO_PIECE)
+        return NO_PIECE;
+    board[position] = NO_PIECE;
+    pieceSquareScore[MIDGAME] -= pieceSquare[MIDGAME][removed][position];
+    pieceSquareScore[ENDGAME] -= pieceSquare[ENDGAME][removed][position];
+    pieces[colorIndex(pieceColor(removed))][pieceType(removed)] &= ~squareBB(position);
+    colorPieces[colorIndex(pieceColor(removed))] &= ~squareBB(position);
+    occupancy &= ~squareBB(position);
+    return removed;
+}
+
+//Moves a piece to an empty square
+void ChessBoard::movePiece(int source, int destination){
+    Piece moving = board[source];
+    Bitboard change = squareBB(source) | squareBB(destination);
+    board[destination] = moving;
+    board[source] = NO_PIECE;
+    pieceSquareScore[MIDGAME] += pieceSquare[MIDGAME][moving][destination] - pieceSquare[MIDGAME][moving][source];
+    pieceSquareScore[ENDGAME] += pieceSquare[ENDGAME][moving][destination] - pieceSquare[ENDGAME][moving][source];
+    pieces[colorIndex(pieceColor(moving))][pieceType(moving)] ^= change;
+    colorPieces[colorIndex(pieceColor(moving))] ^= change;
+    occupancy ^= change;
+}
+
+Bitboard ChessBoard::attackersTo(int position, int color, Bitboard occupied){
+    const Bitboard* own = pieces[colorIndex(color)];
+    //A pawn of color attacks position exactly when a pawn of the other color on position would attack it back
+    return (pawnAttacks[colorIndex(-color)][position] & own[PAWN])
+        | (knightAttacks[position] & own[KNIGHT])
+        | (kingAttacks[position] & own[KING])
+        | (bishopAttacks(position, occupied) & (own[BISHOP] | own[QUEEN]))
+        | (rookAttacks(position, occupied) & (own[ROOK] | own[QUEEN]));
+}
+
+Bitboard ChessBoard::allAttackersTo(int position, Bitboard occupied){
+    return (pawnAttacks[colorIndex(BLACK)][position] & pieces[colorIndex(WHITE)][PAWN])
+        | (pawnAttacks[colorIndex(WHITE)][position] & pieces[colorIndex(BLACK)][PAWN])
+        | (knightAttacks[position] & (pieces[0][KNIGHT] | pieces[1][KNIGHT]))
+        | (kingAttacks[position] & (pieces[0][KING] | pieces[1][KING]))
+        | (bishopAttacks(position, occupied) & (pieces[0][BISHOP] | pieces[1][BISHOP] | pieces[0][QUEEN] | pieces[1][QUEEN]))
+        | (rookAttacks(position, occupied) & (pieces[0][ROOK] | pieces[1][ROOK] | pieces[0][QUEEN] | pieces[1][QUEEN]));
+}
+
+int ChessBoard::staticExchange(Move move){
+    int source = moveFrom(move), destination = moveTo(move);
+    if(moveFlag(move) == MOVE_CASTLING)
+        return 0;
+    //gain[i] is the material balance after the i-th capture, for the side that made it
+    int gain[32];
+    Bitboard occupied = occupancy ^ squareBB(source);
+    int onSquare = pieceValues[pieceType(board[source])];
+    gain[0] = (board[destination] != NO_PIECE? pieceValues[pieceType(board[destination])] : 0);
+    if(moveFlag(move) == MOVE_EN_PASSANT){
+        gain[0] = pieceValues[PAWN];
+        occupied ^= squareBB(destination - 8 * turn);
+    }
+    if(isPromotion(move)){
+        onSquare = pieceValues[promotionType(move)];
+        gain[0] += onSquare - pieceValues[PAWN];
+    }
+
+    Bitboard diagonal = pieces[0][BISHOP] | pieces[1][BISHOP] | pieces[0][QUEEN] | pieces[1][QUEEN];
+    Bitboard straight = pieces[0][ROOK] | pieces[1][ROOK] | pieces[0][QUEEN] | pieces[1][QUEEN];
+    Bitboard attackers = allAttackersTo(destination, occupied) & occupied;
+    int side = turn * -1, captures = 0;
+    while(captures < 31){
+        Bitboard own = attackers & colorPieces[colorIndex(side)];
+        if(!own)
+            break;
+        int type = PAWN;
+        while(!(own & pieces[colorIndex(side)][type]))
+            type++;
+        //The king may only take last
+        if(type == KING && (attackers & colorPieces[colorIndex(side * -1)]))
+            break;
+        captures++;
+        gain[captures] = onSquare - gain[captures - 1];
+        occupied ^= squareBB(lsb(own & pieces[colorIndex(side)][type]));
+        if(type == PAWN || type == BISHOP || type == QUEEN)
+            attackers |= bishopAttacks(destination, occupied) & diagonal;
+        if(type == ROOK || type == QUEEN)
+            attackers |= rookAttacks(destination, occupied) & straight;
+        attackers &= occupied;
+        onSquare = pieceValues[type];
+        side = side * -1;
+    }
+    //Working back from the last capture, each side either makes its capture or stops before it, whichever is better
+    for(; captures > 0; captures--)
+        gain[captures - 1] = -std::max(-gain[captures - 1], gain[captures]);
+    return gain[0];
+}
+
+Bitboard ChessBoard::attacksBy(int color, Bitboard occupied){
+    const Bitboard* own = pieces[colorIndex(color)];
+    Bitboard attacks = kingAttacks[kingSquare(color)];
+    //Pawns are shifted all at once, dropping the captures that would wrap around to the other edge
+    if(color == WHITE)
+        attacks |= ((own[PAWN] & ~FILE_A) << 7) | ((own[PAWN] & ~FILE_H) << 9);
+    else
+        attacks |= ((own[PAWN] & ~FILE_A) >> 9) | ((own[PAWN] & ~FILE_H) >> 7);
+    Bitboard b = own[KNIGHT];
+    while(b)
+        attacks |= knightAttacks[popLsb(b)];
+    b = own[BISHOP] | own[QUEEN];
+    while(b)
+        attacks |= bishopAttacks(popLsb(b), occupied);
+    b = own[ROOK] | own[QUEEN];
+    while(b)
+        attacks |= rookAttacks(popLsb(b), occupied);
+    return attacks;
+}
+
+Bitboard ChessBoard::pinnedPieces(int color){
+    int kingPos = kingSquare(color);
+    const Bitboard* enemy = pieces[colorIndex(-color)];
+    //Enemy sliders that would hit the king on an otherwise empty board
+    Bitboard snipers = (rookAttacks(kingPos, 0) & (enemy[ROOK] | enemy[QUEEN]))
+        | (bishopAttacks(kingPos, 0) & (enemy[BISHOP] | enemy[QUEEN]));
+    Bitboard pinned = 0;
+    while(snipers){
+        Bitboard blockers = betweenMask[kingPos][popLsb(snipers)] & occupancy;
+        if(blockers && !moreThanOne(blockers))
+            pinned |= blockers & colorPieces[colorIndex(color)];
+    }
+    return pinned;
+}
+
+//The attack tables already stop sliders at the first piece in the way, so they answer both the shape of the move and the clear path
+bool Knight::isLegal(ChessBoard*, int source, int destination){
+    return knightAttacks[source] & squareBB(destination);
+}
+
+bool Bishop::isLegal(ChessBoard* chessBoard, int source, int destination){
+    return bishopAttacks(source, chessBoard->getOccupancy()) & squareBB(destination);
+}
+
+bool Rook::isLegal(ChessBoard* chessBoard, int source, int destination){
+    return rookAttacks(source, chessBoard->getOccupancy()) & squareBB(destination);
+}
+
+bool Queen::isLegal(ChessBoard* chessBoard, int source, int destination){
+    return queenAttacks(source, chessBoard->getOccupancy()) & squareBB(destination);
+}
+
+bool King::isLegal(ChessBoard* chessBoard, int source, int destination){
+    if(kingAttacks[source] & squareBB(destination)){
+        return true;
+    }
+    else if(abs(destination - source) == 2 && destination / 8 == source / 8){ //castling
+        int color = pieceColor(chessBoard->getBoard()[source]);
+        int right = (destination > source? WHITE_KINGSIDE : WHITE_QUEENSIDE) << (color == WHITE? 0 : 2);
+        if(!(chessBoard->getCastlingRights() & right))
+            return false;
+        int castlePos = (destination % 8 == 6? source + 3 : source - 4);
+        if(betweenMask[source][castlePos] & chessBoard->getOccupancy())
+            return false;
+        //The king may not castle out of, through or into check
+        int moveDir = (destination % 8 == 6? 1 : -1);
+        return !chessBoard->inCheck() && !(chessBoard->getAttacked() & betweenMask[source][source + 3 * moveDir]);
+    }
+    return false;
+}
+
+//Castling also moves the castle
+Move King::encode(ChessBoard*, int source, int destination){
+    return encodeMove(source, destination, abs(destination - source) == 2? MOVE_CASTLING : MOVE_NORMAL);
+}
+
+//Pushes need every square including the one the pawn lands on to be clear, captures need an enemy piece or the en passant square
+bool Pawn::isLegal(ChessBoard* chessBoard, int source, int destination){
+    int color = pieceColor(chessBoard->getBoard()[source]);
+    Bitboard occupied = chessBoard->getOccupancy();
+    Bitboard startRank = (color == WHITE? RANK_1 << 8 : RANK_8 >> 8);
+    if(destination == 8 * color + source){ //Normal movement
+        return !(occupied & squareBB(destination));
+    }
+    else if((startRank & squareBB(source)) && destination == 16 * color + source){ //Double move
+        return !(occupied & (squareBB(destination) | squareBB(source + 8 * color)));
+    }
+    else if(pawnAttacks[colorIndex(color)][source] & squareBB(destination)){
+        return (chessBoard->getColorPieces(color * -1) & squareBB(destination)) || destination == chessBoard->getEnpassantSquare();
+    }
+    return false;
+}
+
+//En passant is the one capture where the captured piece is not on the destination
+Move Pawn::encode(ChessBoard* chessBoard, int source, int destination){
+    if(destination == chessBoard->getEnpassantSquare() && source % 8 != destination % 8)
+        return encodeMove(source, destination, MOVE_EN_PASSANT);
+    if(destination / 8 == 0 || destination / 8 == 7)
+        return encodeMove(source, destination, MOVE_PROMOTION + QUEEN - KNIGHT); //The piece chosen makes no difference to the king's safety
+    return encodeMove(source, destination);
+}
+
+int Pawn::promote(){
+    char selection;
+    std::cout<<"Select one to promote your pawn to: Queen(Q), Rook(R), Bishop(B), Knight(N)\n";
+    std::cin>>selection;
+    switch (selection){
+    case 'Q':
+        return QUEEN;
+    case 'R':
+        return ROOK;
+    case 'B':
+        return BISHOP;
+    case 'N':
+        return KNIGHT;
+    default:
+        std::cout<<"Invalid input\n";
+        return promote();
+    }
+}
+
+//The castling rights that survive a move from or to each square
+static int castlingMask(int square){
+    switch(square){
+    case 0: return ~WHITE_QUEENSIDE;
+    case 4: return ~(WHITE_KINGSIDE | WHITE_QUEENSIDE);
+    case 7: return ~WHITE_KINGSIDE;
+    case 56: return ~BLACK_QUEENSIDE;
+    case 60: return ~(BLACK_KINGSIDE | BLACK_QUEENSIDE);
+    case 63: return ~BLACK_KINGSIDE;
+    default: return ~0;
+    }
+}
+
+void ChessBoard::makeMove(Move move, UndoRecord& undo){
+    STAT_ADD(STAT_MOVES_MADE, 1);
+    int source = moveFrom(move), destination = moveTo(move);
+    Piece moving = board[source];
+    int color = pieceColor(moving), type = pieceType(moving), us = colorIndex(color);
+    undo.move = move;
+    undo.enpassantSquare = enpassantSquare;
+    undo.castlingRights = castlingRights;
+    undo.halfmoveClock = halfmoveClock;
+    undo.key = key;
+    undo.checkers = checkers;
+    undo.pinned = pinned;
+    undo.attacked = attacked;
+    key ^= zobristCastling[castlingRights] ^ enpassantKey() ^ zobristSide;
+
+    int captureAt = destination;
+    if(moveFlag(move) == MOVE_EN_PASSANT)
+        captureAt = destination - 8 * color;
+    undo.captured = removePiece(captureAt);
+    if(undo.captured != NO_PIECE)
+        key ^= zobristPieces[1 - us][pieceType(undo.captured)][captureAt];
+    movePiece(source, destination);
+    key ^= zobristPieces[us][type][source] ^ zobristPieces[us][type][destination];
+
+    if(moveFlag(move) == MOVE_CASTLING){
+        int castlePos = (destination > source? source + 3 : source - 4);
+        movePiece(castlePos, (source + destination) / 2);
+        key ^= zobristPieces[us][ROOK][castlePos] ^ zobristPieces[us][ROOK][(source + destination) / 2];
+    }
+
+    castlingRights &= castlingMask(source) & castlingMask(destination);
+    if(type == PAWN || undo.captured != NO_PIECE)
+        halfmoveClock = 0;
+    else
+        halfmoveClock++;
+    if(type == PAWN && abs(destination - source) == 16)
+        enpassantSquare = (source + destination) / 2;
+    else
+        enpassantSquare = -1;
+
+    if(isPromotion(move)){
+        removePiece(destination);
+        addPiece(makePiece(color, promotionType(move)), destination);
+        key ^= zobristPieces[us][PAWN][destination] ^ zobristPieces[us][promotionType(move)][destination];
+    }
+    if(turn == BLACK)
+        fullmoveNumber++;
+    turn = turn * -1;
+    key ^= zobristCastling[castlingRights] ^ enpassantKey();
+    updateAttacks();
+    if(accumulators != nullptr)
+        accumulators->push(move, moving, undo.captured, captureAt);
+}
+
+void ChessBoard::unmakeMove(const UndoRecord& undo){
+    STAT_ADD(STAT_MOVES_UNMADE, 1);
+    int source = moveFrom(undo.move), destination = moveTo(undo.move);
+    turn = turn * -1;
+    if(turn == BLACK)
+        fullmoveNumber--;
+    if(isPromotion(undo.move)){
+        removePiece(destination);
+        addPiece(makePiece(turn, PAWN), destination);
+    }
+    movePiece(destination, source);
+
+    if(moveFlag(undo.move) == MOVE_CASTLING){
+        int castlePos = (destination > source? source + 3 : source - 4);
+        movePiece((source + destination) / 2, castlePos);
+    }
+    if(undo.captured != NO_PIECE)
+        addPiece(undo.captured, moveFlag(undo.move) == MOVE_EN_PASSANT? destination - 8 * turn : destination);
+
+    enpassantSquare = undo.enpassantSquare;
+    castlingRights = undo.castlingRights;
+    halfmoveClock = undo.halfmoveClock;
+    key = undo.key;
+    checkers = undo.checkers;
+    pinned = undo.pinned;
+    attacked = undo.attacked;
+    if(accumulators != nullptr)
+        accumulators->pop();
+}
+
+void ChessBoard::updateAttacks(){
+    int kingPos = kingSquare(turn);
+    checkers = attackersTo(kingPos, turn * -1);
+    pinned = pinnedPieces(turn);
+    attacked = attacksBy(turn * -1, occupancy ^ squareBB(kingPos));
+}
+
+void ChessBoard::finishSetup(){
+    for(int color = BLACK; color <= WHITE; color += 2){
+        int home = (color == WHITE? 4 : 60);
+        for(int moveDir = -1; moveDir <= 1; moveDir += 2){
+            int castlePos = (moveDir == 1? home + 3 : home - 4);
+            int right = (moveDir == 1? WHITE_KINGSIDE : WHITE_QUEENSIDE) << (color == WHITE? 0 : 2);
+            if(board[home] != makePiece(color, KING) || board[castlePos] != makePiece(color, ROOK))
+                castlingRights &= ~right;
+        }
+    }
+    key = computeKey();
+    updateAttacks();
+}
+
+uint64_t ChessBoard::computeKey(){
+    uint64_t computed = zobristCastling[castlingRights] ^ enpassantKey();
+    if(turn == BLACK)
+        computed ^= zobristSide;
+    for(int i = 0; i < 2; i++){
+        for(int type = PAWN; type <= KING; type++){
+            Bitboard b = pieces[i][type];
+            while(b)
+                computed ^= zobristPieces[i][type][popLsb(b)];
+        }
+    }
+    return computed;
+}
+
+//The en passant file only counts when a pawn of the side to move is in place to take, otherwise the position is the same as without it
+uint64_t ChessBoard::enpassantKey(){
+    if(enpassantSquare < 0)
+        return 0;
+    if(pawnAttacks[colorIndex(turn * -1)][enpassantSquare] & pieces[colorIndex(turn)][PAWN])
+        return zobristEnpassant[enpassantSquare % 8];
+    return 0;
+}
+
+void newGame(ChessBoard* chessBoard){
+    const int backRank[8] = {ROOK, KNIGHT, BISHOP, QUEEN, KING, BISHOP, KNIGHT, ROOK};
+    for(int file = 0; file < 8; file++){
+        chessBoard->addPiece(makePiece(WHITE, backRank[file]), file);
+        chessBoard->addPiece(makePiece(WHITE, PAWN), 8 + file);
+        chessBoard->addPiece(makePiece(BLACK, PAWN), 48 + file);
+        chessBoard->addPiece(makePiece(BLACK, backRank[file]), 56 + file);
+    }
+    chessBoard->setCastlingRights(WHITE_KINGSIDE | WHITE_QUEENSIDE | BLACK_KINGSIDE | BLACK_QUEENSIDE);
+    chessBoard->finishSetup();
+}
+
+bool onBoard(std::string location){
+    if('a' <= location[0] && location[0] <= 'h' && '1' <= location[1] && location[1] <= '8' && location.length() == 2)
+        return true;
+    return false;
+}
+
+bool onBoard(int position){
+    if(0 <= position && position <= 63)
+        return true;
+    return false;
+}
+
+bool check4checkmate(ChessBoard* chessBoard){
+    return chessBoard->inCheck() && !hasLegalMove(chessBoard);
+}
+
+bool check4checkmate(ChessBoard* chessBoard, LegalMoveCache& legal){
+    if(!chessBoard->inCheck())
+        return false;
+    legal.update(chessBoard);
+    return legal.count() == 0;
+}
+
+bool insufficientMaterial(ChessBoard* chessBoard){
+    Bitboard heavy = 0, knights = 0, bishops = 0;
+    for(int color = BLACK; color <= WHITE; color += 2){
+        heavy |= chessBoard->getPieces(color, PAWN) | chessBoard->getPieces(color, ROOK) | chessBoard->getPieces(color, QUEEN);
+        knights |= chessBoard->getPieces(color, KNIGHT);
+        bishops |= chessBoard->getPieces(color, BISHOP);
+    }
+    if(heavy)
+        return false;
+    if(popCount(knights | bishops) <= 1)
+        return true;
+    const Bitboard DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+    return !knights && (!(bishops & DARK_SQUARES) || !(bishops & ~DARK_SQUARES));
+}
+
+//The draws that do not depend on whether there is a legal move
+static int drawStatus(ChessBoard* chessBoard){
+    if(insufficientMaterial(chessBoard))
+        return STATUS_INSUFFICIENT_MATERIAL;
+    if(chessBoard->getHalfmoveClock() >= 100)
+        return STATUS_FIFTY_MOVES;
+    return STATUS_PLAYING;
+}
+
+int gameStatus(ChessBoard* chessBoard){
+    if(!hasLegalMove(chessBoard))
+        return chessBoard->inCheck()? STATUS_CHECKMATE : STATUS_STALEMATE;
+    return drawStatus(chessBoard);
+}
+
+int gameStatus(ChessBoard* chessBoard, LegalMoveCache& legal){
+    legal.update(chessBoard);
+    if(legal.count() == 0)
+        return chessBoard->inCheck()? STATUS_CHECKMATE : STATUS_STALEMATE;
+    return drawStatus(chessBoard);
+}
+
+std::string statusName(int status){
+    switch(status){
+    case STATUS_CHECKMATE: return "checkmate";
+    case STATUS_STALEMATE: return "stalemate";
+    case STATUS_INSUFFICIENT_MATERIAL: return "insufficient material";
+    case STATUS_FIFTY_MOVES: return "fifty-move rule";
+    default: return "playing";
+    }
+}
+
+//Names are worked out from where a piece stands: pawns are numbered by their file, and rooks, knights and bishops
+//carry a Q or K for the half of the board they are on. A lowercase first letter is a black piece.
+static std::string pieceName(Piece piece, int position){
+    std::string name;
+    switch(pieceType(piece)){
+    case PAWN:
+        name = std::string(1, 'P') + char('1' + position % 8);
+        break;
+    case KING:
+        name = "KK";
+        break;
+    case QUEEN:
+        name = "QQ";
+        break;
+    default:
+        name = std::string(1, position % 8 < 4? 'Q' : 'K') + "PNBRQK"[pieceType(piece)];
+    }
+    if(pieceColor(piece) == BLACK)
+        name[0] |= 32;
+    return name;
+}
+
+//The board is built up in one string and written at once, the stream is flushed anyway when input is next read
+void printBoard(int turn, ChessBoard* chessBoard){
+    std::cout<<boardText(turn, chessBoard);
+}
+
+std::string boardText(int turn, ChessBoard* chessBoard){
+    std::string text = "\n";
+    for(char letter = -3.5 * turn + 100.5; 'a' <= letter && letter <= 'h'; letter += turn)
+        text += std::string("\t") + letter;
+    text += "\n";
+
+    for(int i = 3.5 * turn + 4.5; 1 <= i && i <= 8; i += turn * -1){
+        text += std::to_string(i) + "\t";
+        for(int j = 8 * i - (3.5 * turn + 4.5); 8 * (i - 1) <= j && j < 8 * i; j += turn){
+            if(chessBoard->getBoard()[j] != NO_PIECE)
+                text += pieceName(chessBoard->getBoard()[j], j) + "\t";
+            else
+                text += "--\t";
+        }
+        text += std::to_string(i) + "\n";
+    }
+
+    for(char letter = -3.5 * turn + 100.5; letter >= 'a' && letter <= 'h'; letter += turn)
+        text += std::string("\t") + letter;
+    text += "\n";
+    return text;
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#ifndef CHESS_H
+#define CHESS_H
+
+#include <string>
+#include "bitboard.h"
+#include "move.h"
+#include "stats.h"
+
+//-1 and 1 are used instead of 0 and 1 to denote direction across the board
+const int BLACK = -1;
+const int WHITE = 1;
+
+//Piece types, used to index the bitboards kept by ChessBoard
+const int PAWN = 0;
+const int KNIGHT = 1;
+const int BISHOP = 2;
+const int ROOK = 3;
+const int QUEEN = 4;
+const int KING = 5;
+
+//Castling rights, one bit per side of the board for each color
+const int WHITE_KINGSIDE = 1;
+const int WHITE_QUEENSIDE = 2;
+const int BLACK_KINGSIDE = 4;
+const int BLACK_QUEENSIDE = 8;
+
+//Maps BLACK and WHITE to 0 and 1 for indexing per-color arrays
+inline int colorIndex(int color) {return (color + 1) / 2;}
+
+//A piece is a single byte: its type plus one in the low three bits and its color in bit 3, 0 is an empty square
+typedef uint8_t Piece;
+const Piece NO_PIECE = 0;
+constexpr Piece makePiece(int color, int type) {return Piece((type + 1) | (color == WHITE? 8 : 0));}
+constexpr int pieceType(Piece piece) {return (piece & 7) - 1;}
+constexpr int pieceColor(Piece piece) {return (piece & 8)? WHITE : BLACK;}
+
+class ChessBoard;
+struct TablebaseResult;
+class AccumulatorStack;
+class LegalMoveCache;
+void newGame(ChessBoard* chessBoard);
+bool onBoard(std::string location);
+bool onBoard(int position);
+//Checks that the piece on source belongs to the side to move and may go to destination, then plays the move.
+//Explains what is wrong and returns false otherwise.
+//The move made is written to played when given.
+bool playMove(ChessBoard* chessBoard, int source, int destination, int turn, Move* played = nullptr);
+//The checks of playMove without playing or asking anything: the reason the move is refused, or nullptr when it is
+//legal, with move set to it (a queen promotion for a pawn reaching the last rank)
+const char* checkMove(ChessBoard* chessBoard, int source, int destination, int turn, Move& move);
+//playMove checking against the turn's legal moves (movegen.h) instead of trying the move on the board. Only a
+//refused move is looked at further, to say what is wrong and list the moves the piece does have.
+bool playMove(ChessBoard* chessBoard, int source, int destination, int turn, LegalMoveCache& legal, Move* played = nullptr);
+//E.g. "Legal moves from e2: e3 e4"
+std::string moveHint(int source, LegalMoveCache& legal);
+//Whether the side to move is checkmated
+bool check4checkmate(ChessBoard* chessBoard);
+bool check4checkmate(ChessBoard* chessBoard, LegalMoveCache& legal);
+//Whether the game is over in the position, not counting repetitions which depend on the moves that led to it
+const int STATUS_PLAYING = 0;
+const int STATUS_CHECKMATE = 1;
+const int STATUS_STALEMATE = 2;
+const int STATUS_INSUFFICIENT_MATERIAL = 3;
+const int STATUS_FIFTY_MOVES = 4;
+int gameStatus(ChessBoard* chessBoard);
+//The same from the position's cached legal moves, which are then ready for checking the next move typed
+int gameStatus(ChessBoard* chessBoard, LegalMoveCache& legal);
+//E.g. "checkmate" or "insufficient material", for reports
+std::string statusName(int status);
+//Neither side can ever mate: bare kings, a single minor piece, or only bishops all on squares of one color
+bool insufficientMaterial(ChessBoard* chessBoard);
+void printBoard(int turn, ChessBoard* chessBoard);
+//What printBoard writes
+std::string boardText(int turn, ChessBoard* chessBoard);
+
+//The rules of each piece type are classes with only static members, so playMove is instantiated once per type
+//and every check is a direct call. isLegal makes sure the destination is legal for that piece in that position,
+//including that nothing stands in the way, and encode adds the flag the move needs.
+struct PieceRules{
+    static Move encode(ChessBoard*, int source, int destination) {return encodeMove(source, destination);}
+};
+
+struct King: PieceRules{
+    static const int type = KING;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+    static Move encode(ChessBoard* chessBoard, int source, int destination);
+};
+
+struct Queen: PieceRules{
+    static const int type = QUEEN;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+};
+
+struct Rook: PieceRules{
+    static const int type = ROOK;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+};
+
+struct Bishop: PieceRules{
+    static const int type = BISHOP;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+};
+
+struct Knight: PieceRules{
+    static const int type = KNIGHT;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+};
+
+struct Pawn: PieceRules{
+    static const int type = PAWN;
+    static bool isLegal(ChessBoard* chessBoard, int source, int destination);
+    static Move encode(ChessBoard* chessBoard, int source, int destination);
+    //Asks which piece the pawn becomes and returns its type
+    static int promote();
+};
+
+//Everything makeMove changes that cannot be worked out again from the move itself
+struct UndoRecord{
+    Move move;
+    Piece captured;
+    int enpassantSquare;
+    int castlingRights;
+    int halfmoveClock;
+    uint64_t key;
+    Bitboard checkers;
+    Bitboard pinned;
+    Bitboard attacked;
+};
+
+//A board is a plain value of 256 bytes, so copying one is a memcpy
+class ChessBoard{
+private:
+    //One mask per color (black, white) and piece type, kept in step with board by addPiece, removePiece and movePiece
+    Bitboard pieces[2][6] {};
+    Bitboard colorPieces[2] {};
+    Bitboard occupancy = 0;
+    //Zobrist key of the position, updated by makeMove and restored by unmakeMove
+    uint64_t key = 0;
+    Piece board[64] {};
+    int turn = WHITE;
+    //The square a pawn has just passed over with a double move, -1 if the last move was not one
+    int enpassantSquare = -1;
+    int castlingRights = 0;
+    int halfmoveClock = 0;
+    int fullmoveNumber = 1;
+    //Worked out for the side to move by makeMove and finishSetup and restored by unmakeMove: the enemy pieces giving check,
+    //own pieces pinned to the king, and every square the enemy attacks. Sliders look through the king for the last one,
+    //so the king cannot step back along a checking ray.
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+    Bitboard attacked = 0;
+    //Sum of the piece-square values (eval.h) of every piece for the middlegame and the endgame, kept by addPiece,
+    //removePiece and movePiece
+    int pieceSquareScore[2] {};
+    //The network accumulators of the search playing on this board (nnue.h), which makeMove and unmakeMove keep in step
+    AccumulatorStack* accumulators = nullptr;
+    void updateAttacks();
+    uint64_t enpassantKey();
+public:
+    void addPiece(Piece piece, int position);
+    Piece removePiece(int position);
+    void movePiece(int source, int destination);
+    //Plays a move without any legality checks, saving what unmakeMove needs in undo
+    void makeMove(Move move, UndoRecord& undo);
+    void unmakeMove(const UndoRecord& undo);
+    //Called once the pieces, turn, castling rights and en passant square of a new position are in place.
+    //Drops the castling rights of kings and castles that are not on their starting squares, then computes the key from scratch.
+    void finishSetup();
+    uint64_t computeKey();
+    uint64_t getKey() {return key;}
+    int getTurn() {return turn;}
+    void setTurn(int color) {turn = color;}
+    int getCastlingRights() {return castlingRights;}
+    void setCastlingRights(int rights) {castlingRights = rights;}
+    int getHalfmoveClock() {return halfmoveClock;}
+    void setHalfmoveClock(int clock) {halfmoveClock = clock;}
+    int getFullmoveNumber() {return fullmoveNumber;}
+    void setFullmoveNumber(int number) {fullmoveNumber = number;}
+    Piece* getBoard() {return board;}
+    int getEnpassantSquare() {return enpassantSquare;}
+    void setEnpassantSquare(int square) {enpassantSquare = square;}
+    Bitboard getPieces(int color, int type) {return pieces[colorIndex(color)][type];}
+    Bitboard getColorPieces(int color) {return colorPieces[colorIndex(color)];}
+    Bitboard getOccupancy() {return occupancy;}
+    int kingSquare(int color) {return lsb(pieces[colorIndex(color)][KING]);}
+    //Constant-time questions about the side to move
+    bool inCheck() {return checkers != 0;}
+    Bitboard getCheckers() {return checkers;}
+    Bitboard getPinned() {return pinned;}
+    bool isPinned(int position) {return (pinned & squareBB(position)) != 0;}
+    Bitboard getAttacked() {return attacked;}
+    bool isAttacked(int position) {return (attacked & squareBB(position)) != 0;}
+    //Every piece of the given color attacking position, with sliders looking through the given occupancy
+    Bitboard attackersTo(int position, int color, Bitboard occupied);
+    Bitboard attackersTo(int position, int color) {return attackersTo(position, color, occupancy);}
+    //Every piece of either color attacking position, with sliders looking through the given occupancy. Removing
+    //an attacker from occupied and asking again uncovers the sliders that stood behind it.
+    Bitboard allAttackersTo(int position, Bitboard occupied);
+    //Static exchange evaluation: the centipawns the side to move wins by playing move, a capture or promotion, if
+    //both sides then go on capturing on its destination with their least valuable piece for as long as it pays.
+    //Nothing is played; pins are not taken into account.
+    int staticExchange(Move move);
+    //Every square the pieces of the given color attack, with sliders looking through the given occupancy
+    Bitboard attacksBy(int color, Bitboard occupied);
+    //Pieces of the given color that are the only thing standing between their king and an enemy slider
+    Bitboard pinnedPieces(int color);
+    bool isThreatened(int position, int color) {STAT_ADD(STAT_THREAT_QUERIES, 1); return attackersTo(position, color) != 0;}
+    int getPieceSquareScore(int phase) {return pieceSquareScore[phase];}
+    AccumulatorStack* getAccumulators() {return accumulators;}
+    //A search attaches its own stack for as long as it runs and detaches it with nullptr
+    void setAccumulators(AccumulatorStack* stack) {accumulators = stack;}
+    //Looks the position up in the endgame tables mapped by loadTablebases (tablebase.h), false when they do not hold it
+    bool probeTablebase(TablebaseResult& result);
+};
+
+#endif
@@ -0,0 +1,246 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "eval.h"
+#include "fen.h"
+#include "movegen.h"
+#include "nnue.h"
+
+int pieceSquare[2][16][64];
+
+//Bonuses for white pieces from a8 to h1, as the board is printed, indexed by piece type. The king has a table for
+//each phase: sheltered behind its pawns while queens are about, in the centre once the board empties.
+static const int pieceTables[6][64] = {
+    {  0,   0,   0,   0,   0,   0,   0,   0,
+      50,  50,  50,  50,  50,  50,  50,  50,
+      10,  10,  20,  30,  30,  20,  10,  10,
+       5,   5,  10,  25,  25,  10,   5,   5,
+       0,   0,   0,  20,  20,   0,   0,   0,
+       5,  -5, -10,   0,   0, -10,  -5,   5,
+       5,  10,  10, -20, -20,  10,  10,   5,
+       0,   0,   0,   0,   0,   0,   0,   0},
+    {-50, -40, -30, -30, -30, -30, -40, -50,
+     -40, -20,   0,   0,   0,   0, -20, -40,
+     -30,   0,  10,  15,  15,  10,   0, -30,
+     -30,   5,  15,  20,  20,  15,   5, -30,
+     -30,   0,  15,  20,  20,  15,   0, -30,
+     -30,   5,  10,  15,  15,  10,   5, -30,
+     -40, -20,   0,   5,   5,   0, -20, -40,
+     -50, -40, -30, -30, -30, -30, -40, -50},
+    {-20, -10, -10, -10, -10, -10, -10, -20,
+     -10,   0,   0,   0,   0,   0,   0, -10,
+     -10,   0,   5,  10,  10,   5,   0, -10,
+     -10,   5,   5,  10,  10,   5,   5, -10,
+     -10,   0,  10,  10,  10,  10,   0, -10,
+     -10,  10,  10,  10,  10,  10,  10, -10,
+     -10,   5,   0,   0,   0,   0,   5, -10,
+     -20, -10, -10, -10, -10, -10, -10, -20},
+    {  0,   0,   0,   0,   0,   0,   0,   0,
+       5,  10,  10,  10,  10,  10,  10,   5,
+      -5,   0,   0,   0,   0,   0,   0,  -5,
+      -5,   0,   0,   0,   0,   0,   0,  -5,
+      -5,   0,   0,   0,   0,   0,   0,  -5,
+      -5,   0,   0,   0,   0,   0,   0,  -5,
+      -5,   0,   0,   0,   0,   0,   0,  -5,
+       0,   0,   0,   5,   5,   0,   0,   0},
+    {-20, -10, -10,  -5,  -5, -10, -10, -20,
+     -10,   0,   0,   0,   0,   0,   0, -10,
+     -10,   0,   5,   5,   5,   5,   0, -10,
+      -5,   0,   5,   5,   5,   5,   0,  -5,
+       0,   0,   5,   5,   5,   5,   0,  -5,
+     -10,   5,   5,   5,   5,   5,   0, -10,
+     -10,   0,   5,   0,   0,   0,   0, -10,
+     -20, -10, -10,  -5,  -5, -10, -10, -20},
+    {-30, -40, -40, -50, -50, -40, -40, -30,
+     -30, -40, -40, -50, -50, -40, -40, -30,
+     -30, -40, -40, -50, -50, -40, -40, -30,
+     -30, -40, -40, -50, -50, -40, -40, -30,
+     -20, -30, -30, -40, -40, -30, -30, -20,
+     -10, -20, -20, -20, -20, -20, -20, -10,
+      20,  20,   0,   0,   0,   0,  20,  20,
+      20,  30,  10,   0,   0,  10,  30,  20}
+};
+
+static const int kingEndgameTable[64] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50
+};
+
+//Phase weights of each piece type, a full set of pieces adds up to TOTAL_PHASE
+static const int phaseWeights[6] = {0, 1, 1, 2, 4, 0};
+static const int TOTAL_PHASE = 24;
+
+void initEval(){
+    for(int type = PAWN; type <= KING; type++){
+        for(int position = 0; position < 64; position++){
+            //The tables list a8 first, so a white piece on position reads row 7 - rank and a black one the mirror image
+            int midgame = pieceValues[type] + pieceTables[type][position ^ 56];
+            int endgame = pieceValues[type] + (type == KING? kingEndgameTable[position ^ 56] : pieceTables[type][position ^ 56]);
+            pieceSquare[MIDGAME][makePiece(WHITE, type)][position] = midgame;
+            pieceSquare[ENDGAME][makePiece(WHITE, type)][position] = endgame;
+            pieceSquare[MIDGAME][makePiece(BLACK, type)][position ^ 56] = -midgame;
+            pieceSquare[ENDGAME][makePiece(BLACK, type)][position ^ 56] = -endgame;
+        }
+    }
+}
+
+static int pieceSquareEvaluate(ChessBoard* chessBoard){
+    int phase = 0;
+    for(int type = KNIGHT; type < KING; type++)
+        phase += phaseWeights[type] * popCount(chessBoard->getPieces(WHITE, type) | chessBoard->getPieces(BLACK, type));
+    if(phase > TOTAL_PHASE)
+        phase = TOTAL_PHASE;
+    int score = (chessBoard->getPieceSquareScore(MIDGAME) * phase + chessBoard->getPieceSquareScore(ENDGAME) * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+    return score * chessBoard->getTurn();
+}
+
+int evaluate(ChessBoard* chessBoard){
+    if(chessBoard->getAccumulators() != nullptr)
+        return networkEvaluate(chessBoard, chessBoard->getAccumulators()->current());
+    return pieceSquareEvaluate(chessBoard);
+}
+
+//Random games from the starting position: every position reached, and the moves of each game to replay them
+static void randomGames(int count, std::vector<ChessBoard>& positions, std::vector<std::vector<Move>>& games){
+    std::mt19937_64 random(1);
+    for(int game = 0; game < count; game++){
+        ChessBoard chessBoard;
+        newGame(&chessBoard);
+        games.emplace_back();
+        while(gameStatus(&chessBoard) == STATUS_PLAYING && games.back().size() < 300){
+            MoveList list;
+            generateLegalMoves(&chessBoard, list);
+            Move move = list.moves[random() % list.size()];
+            UndoRecord undo;
+            chessBoard.makeMove(move, undo);
+            games.back().push_back(move);
+            positions.push_back(chessBoard);
+        }
+    }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int benchmark(int games){
+    std::vector<ChessBoard> positions;
+    std::vector<std::vector<Move>> moves;
+    randomGames(games, positions, moves);
+    bool trained = networkLoaded();
+    if(!trained)
+        randomNetwork(1);
+    std::cout<<positions.size()<<" positions from "<<games<<" random games, "<<(trained? "loaded" : "random")<<" network\n";
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t checksum = 0;
+    for(ChessBoard& chessBoard: positions)
+        checksum += pieceSquareEvaluate(&chessBoard);
+    double seconds = secondsSince(start);
+    //The sums kept by the boards must match those added up afresh
+    for(ChessBoard& chessBoard: positions){
+        ChessBoard rebuilt;
+        for(int position = 0; position < 64; position++){
+            if(chessBoard.getBoard()[position] != NO_PIECE)
+                rebuilt.addPiece(chessBoard.getBoard()[position], position);
+        }
+        rebuilt.setTurn(chessBoard.getTurn());
+        checksum -= pieceSquareEvaluate(&rebuilt);
+    }
+    std::cout<<"piece-square\t"<<uint64_t(positions.size() / (seconds > 0? seconds : 1e-9))<<" positions/s\t"<<(checksum == 0? "ok" : "MISMATCH")<<"\n";
+
+    //Every set of kernels must give the same evaluations, and the accumulators followed move by move the same as
+    //those worked out afresh
+    bool agreed = (checksum == 0);
+    int64_t expected = 0;
+    double scalarRefresh = 0, scalarIncremental = 0;
+    for(int simd = SIMD_SCALAR; simd <= simdSupported(); simd++){
+        setSimdLevel(simd);
+        start = std::chrono::steady_clock::now();
+        int64_t refreshSum = 0;
+        for(ChessBoard& chessBoard: positions){
+            Accumulator accumulator;
+            refreshAccumulator(&chessBoard, accumulator);
+            refreshSum += networkEvaluate(&chessBoard, accumulator);
+        }
+        double refreshSeconds = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        int64_t incrementalSum = 0;
+        AccumulatorStack stack;
+        for(const std::vector<Move>& game: moves){
+            ChessBoard chessBoard;
+            newGame(&chessBoard);
+            stack.reset(&chessBoard);
+            chessBoard.setAccumulators(&stack);
+            for(Move move: game){
+                UndoRecord undo;
+                chessBoard.makeMove(move, undo);
+                incrementalSum += evaluate(&chessBoard);
+            }
+        }
+        double incrementalSeconds = secondsSince(start);
+
+        if(simd == SIMD_SCALAR){
+            expected = refreshSum;
+            scalarRefresh = refreshSeconds;
+            scalarIncremental = incrementalSeconds;
+        }
+        bool same = (refreshSum == expected && incrementalSum == expected);
+        agreed = agreed && same;
+        std::cout<<simdName(simd)<<"\trefresh "<<uint64_t(positions.size() / (refreshSeconds > 0? refreshSeconds : 1e-9))
+        <<" positions/s ("<<scalarRefresh / refreshSeconds<<"x)\tincremental "<<uint64_t(positions.size() / (incrementalSeconds > 0? incrementalSeconds : 1e-9))
+        <<" positions/s ("<<scalarIncremental / incrementalSeconds<<"x)\t"<<(same? "ok" : "MISMATCH")<<"\n";
+    }
+    setSimdLevel(simdSupported());
+    if(!trained)
+        unloadNetwork();
+    return agreed? 0 : 1;
+}
+
+int evalCommand(int argc, char* argv[]){
+    if(argc > 2 && std::string(argv[2]) == "bench"){
+        int games = (argc > 3? atoi(argv[3]) : 1000);
+        if(games < 1){
+            std::cout<<"Usage: chess eval bench [games]\n";
+            return 1;
+        }
+        return benchmark(games);
+    }
+
+    ChessBoard chessBoard;
+    if(argc > 2){
+        std::string fen = argv[2];
+        for(int i = 3; i < argc; i++)
+            fen += std::string(" ") + argv[i];
+        if(!setupPosition(&chessBoard, fen)){
+            std::cout<<"Invalid FEN: "<<fen<<"\n";
+            return 1;
+        }
+    }
+    else
+        newGame(&chessBoard);
+    std::cout<<"piece-square "<<pieceSquareEvaluate(&chessBoard)<<"\n";
+    MoveList captures;
+    generateLegalMoves(&chessBoard, captures, true);
+    if(captures.size() > 0){
+        std::cout<<"exchanges";
+        for(int i = 0; i < captures.size(); i++)
+            std::cout<<" "<<moveToString(captures.moves[i])<<" "<<chessBoard.staticExchange(captures.moves[i]);
+        std::cout<<"\n";
+    }
+    if(networkLoaded()){
+        Accumulator accumulator;
+        refreshAccumulator(&chessBoard, accumulator);
+        std::cout<<"network "<<networkEvaluate(&chessBoard, accumulator)<<" ("<<simdName(simdLevel())<<")\n";
+    }
+    return 0;
+}
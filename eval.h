@@ -0,0 +1,25 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "chess.h"
+
+//Centipawn values indexed by piece type, the king is never traded so it counts for nothing
+const int pieceValues[6] = {100, 320, 330, 500, 900, 0};
+
+//Piece-square values in centipawns, material included, indexed by phase, Piece and square. They are seen from white's
+//side, so black pieces count negative, and ChessBoard keeps the sum over its pieces for both phases.
+const int MIDGAME = 0;
+const int ENDGAME = 1;
+extern int pieceSquare[2][16][64];
+//Must be called once before any board is set up
+void initEval();
+
+//Static evaluation in centipawns from the point of view of the side to move. The network (nnue.h) evaluates when a
+//search has attached its accumulators to the board, otherwise the piece-square sums are blended by the material left.
+int evaluate(ChessBoard* chessBoard);
+
+//Entry point for "chess eval [fen]", which prints the evaluation of a position and the exchange value of each capture,
+//and "chess eval bench [games]", which times the evaluations with every set of kernels this processor runs
+int evalCommand(int argc, char* argv[]);
+
+#endif
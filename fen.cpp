@@ -0,0 +1,134 @@
+#include <sstream>
+#include "fen.h"
+
+static const std::string pieceSymbols = "PNBRQK";
+
+//Uppercase FEN letters are white pieces, lowercase black
+static Piece pieceFromSymbol(char symbol){
+    size_t type = pieceSymbols.find(char(symbol & ~32));
+    if(type == std::string::npos)
+        return NO_PIECE;
+    return makePiece(('A' <= symbol && symbol <= 'Z')? WHITE : BLACK, type);
+}
+
+static bool isNumber(const std::string& text){
+    return !text.empty() && text.size() < 8 && text.find_first_not_of("0123456789") == std::string::npos;
+}
+
+bool setupPosition(ChessBoard* chessBoard, const std::string& fen){
+    std::istringstream fields(fen);
+    std::string placement, side, castling, enpassant, counter;
+    if(!(fields>>placement>>side>>castling>>enpassant))
+        return false;
+
+    ChessBoard parsed;
+    int rank = 7, file = 0;
+    for(char symbol: placement){
+        if(symbol == '/'){
+            if(file != 8 || rank == 0)
+                return false;
+            rank--;
+            file = 0;
+        }
+        else if('1' <= symbol && symbol <= '8')
+            file += symbol - '0';
+        else{
+            Piece piece = pieceFromSymbol(symbol);
+            if(piece == NO_PIECE || file > 7)
+                return false;
+            if(pieceType(piece) == PAWN && (rank == 0 || rank == 7))
+                return false;
+            parsed.addPiece(piece, rank * 8 + file);
+            file++;
+        }
+        if(file > 8)
+            return false;
+    }
+    if(rank != 0 || file != 8)
+        return false;
+    if(popCount(parsed.getPieces(WHITE, KING)) != 1 || popCount(parsed.getPieces(BLACK, KING)) != 1)
+        return false;
+
+    if(side != "w" && side != "b")
+        return false;
+    int color = (side == "w"? WHITE : BLACK);
+    parsed.setTurn(color);
+
+    const std::string rights = "KQkq";
+    int castlingRights = 0;
+    if(castling != "-"){
+        for(char right: castling){
+            if(rights.find(right) == std::string::npos)
+                return false;
+            castlingRights |= 1 << rights.find(right);
+        }
+    }
+    parsed.setCastlingRights(castlingRights);
+
+    //The square passed over is on the sixth rank when white is to move and on the third when black is
+    if(enpassant != "-"){
+        if(enpassant.size() != 2 || enpassant[0] < 'a' || enpassant[0] > 'h' || enpassant[1] != (color == WHITE? '6' : '3'))
+            return false;
+        int square = enpassant[0] - 'a' + (enpassant[1] - '1') * 8;
+        if(parsed.getBoard()[square - 8 * color] == makePiece(color * -1, PAWN))
+            parsed.setEnpassantSquare(square);
+    }
+
+    if(fields>>counter && isNumber(counter)){
+        parsed.setHalfmoveClock(std::stoi(counter));
+        if(fields>>counter && isNumber(counter))
+            parsed.setFullmoveNumber(std::stoi(counter) > 0? std::stoi(counter) : 1);
+    }
+
+    if(parsed.isThreatened(parsed.kingSquare(color * -1), color))
+        return false;
+    parsed.finishSetup();
+    *chessBoard = parsed;
+    return true;
+}
+
+std::string boardToFen(ChessBoard* chessBoard, bool counters){
+    std::string fen;
+    Piece* board = chessBoard->getBoard();
+    for(int rank = 7; rank >= 0; rank--){
+        int empty = 0;
+        for(int file = 0; file < 8; file++){
+            Piece piece = board[rank * 8 + file];
+            if(piece == NO_PIECE){
+                empty++;
+                continue;
+            }
+            if(empty > 0)
+                fen += char('0' + empty);
+            empty = 0;
+            char symbol = pieceSymbols[pieceType(piece)];
+            fen += (pieceColor(piece) == WHITE? symbol : char(symbol | 32));
+        }
+        if(empty > 0)
+            fen += char('0' + empty);
+        if(rank > 0)
+            fen += '/';
+    }
+
+    fen += (chessBoard->getTurn() == WHITE? " w " : " b ");
+    int castlingRights = chessBoard->getCastlingRights();
+    for(int r = 0; r < 4; r++){
+        if(castlingRights & (1 << r))
+            fen += "KQkq"[r];
+    }
+    if(castlingRights == 0)
+        fen += '-';
+
+    int square = chessBoard->getEnpassantSquare();
+    if(square >= 0){
+        fen += ' ';
+        fen += char('a' + square % 8);
+        fen += char('1' + square / 8);
+    }
+    else
+        fen += " -";
+
+    if(counters)
+        fen += " " + std::to_string(chessBoard->getHalfmoveClock()) + " " + std::to_string(chessBoard->getFullmoveNumber());
+    return fen;
+}
@@ -0,0 +1,15 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include <string>
+#include "chess.h"
+
+//Sets up an empty board from a FEN record. EPD records work too: the move counters are optional and anything
+//after the first four fields that is not a counter is ignored. Returns false, leaving the board alone, when the
+//record is malformed or describes a position that cannot arise (a missing king, pawns on the back rank,
+//the side not to move in check).
+bool setupPosition(ChessBoard* chessBoard, const std::string& fen);
+//The FEN record of the position, or just its first four fields as used by EPD
+std::string boardToFen(ChessBoard* chessBoard, bool counters = true);
+
+#endif
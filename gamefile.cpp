@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "gamefile.h"
+#include "fen.h"
+#include "movegen.h"
+
+bool GameWriter::write(const std::string& startFen, const std::vector<Move>& moves, int result){
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    if(!file)
+        return false;
+    if(file.tellp() == 0)
+        file.write(GAME_FILE_MAGIC, sizeof(GAME_FILE_MAGIC));
+
+    GameHeader header = {uint32_t(moves.size()), uint8_t(result), uint8_t(startFen.size()), 0};
+    file.write((const char*)&header, sizeof(header));
+    if(!startFen.empty()){
+        file.write(startFen.data(), startFen.size());
+        if(startFen.size() % 2 != 0)
+            file.put(' ');
+    }
+    file.write((const char*)moves.data(), moves.size() * sizeof(Move));
+    return bool(file);
+}
+
+GameArchive::~GameArchive(){
+    if(data != nullptr)
+        munmap((void*)data, size);
+}
+
+bool GameArchive::open(const std::string& path){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(GAME_FILE_MAGIC)){
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return false;
+    data = (const unsigned char*)mapping;
+    size = info.st_size;
+    if(memcmp(data, GAME_FILE_MAGIC, sizeof(GAME_FILE_MAGIC)) != 0)
+        return false;
+
+    //A game cut short by an interrupted write is left out
+    size_t offset = sizeof(GAME_FILE_MAGIC);
+    while(offset + sizeof(GameHeader) <= size){
+        GameHeader game;
+        memcpy(&game, data + offset, sizeof(game));
+        size_t length = sizeof(GameHeader) + (game.fenLength + 1) / 2 * 2 + size_t(game.plies) * sizeof(Move);
+        if(offset + length > size)
+            break;
+        offsets.push_back(offset);
+        offset += length;
+    }
+    return true;
+}
+
+GameHeader GameArchive::header(size_t game){
+    GameHeader header;
+    memcpy(&header, data + offsets[game], sizeof(header));
+    return header;
+}
+
+std::string GameArchive::startFen(size_t game){
+    return std::string((const char*)(data + offsets[game] + sizeof(GameHeader)), header(game).fenLength);
+}
+
+Move GameArchive::move(size_t game, int ply){
+    Move move;
+    memcpy(&move, data + offsets[game] + sizeof(GameHeader) + (header(game).fenLength + 1) / 2 * 2 + ply * sizeof(Move), sizeof(move));
+    return move;
+}
+
+bool GameArchive::replay(size_t game, int ply, ChessBoard* chessBoard){
+    GameHeader stored = header(game);
+    *chessBoard = ChessBoard();
+    if(stored.fenLength == 0)
+        newGame(chessBoard);
+    else if(!setupPosition(chessBoard, startFen(game))){
+        *chessBoard = ChessBoard();
+        newGame(chessBoard);
+        return false;
+    }
+    const unsigned char* moves = data + offsets[game] + sizeof(GameHeader) + (stored.fenLength + 1) / 2 * 2;
+    int count = (ply < int(stored.plies)? ply : int(stored.plies));
+    UndoRecord undo;
+    for(int i = 0; i < count; i++){
+        Move move;
+        memcpy(&move, moves + i * sizeof(Move), sizeof(move));
+        if(!isLegalMove(chessBoard, move))
+            return false;
+        chessBoard->makeMove(move, undo);
+    }
+    return true;
+}
+
+int gamesCommand(int argc, char* argv[]){
+    if(argc < 3){
+        std::cout<<"Usage: chess games <file> [game] [ply]\n";
+        return 1;
+    }
+    GameArchive archive;
+    if(!archive.open(argv[2])){
+        std::cout<<"Cannot read games from "<<argv[2]<<"\n";
+        return 1;
+    }
+    ChessBoard chessBoard;
+
+    //Games are numbered from 1 as in PGN databases
+    if(argc > 3){
+        size_t game = atol(argv[3]);
+        if(game < 1 || game > archive.gameCount()){
+            std::cout<<"There are "<<archive.gameCount()<<" games\n";
+            return 1;
+        }
+        int ply = (argc > 4? atoi(argv[4]) : archive.plies(game - 1));
+        if(!archive.replay(game - 1, ply, &chessBoard))
+            std::cout<<"Game "<<game<<" is damaged, showing the position where it stops making sense\n";
+        printBoard(chessBoard.getTurn(), &chessBoard);
+        std::cout<<boardToFen(&chessBoard)<<"\n";
+        return 0;
+    }
+
+    uint64_t plies = 0;
+    size_t damaged = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t game = 0; game < archive.gameCount(); game++){
+        if(!archive.replay(game, archive.plies(game), &chessBoard))
+            damaged++;
+        plies += archive.plies(game);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(seconds <= 0)
+        seconds = 1e-9;
+    std::cout<<archive.gameCount()<<" games, "<<plies<<" plies replayed in "<<seconds<<" s\n"
+    <<uint64_t(archive.gameCount() / seconds)<<" games/s, "<<uint64_t(plies / seconds)<<" plies/s\n";
+    if(damaged > 0)
+        std::cout<<damaged<<" damaged games stopped at their first bad move\n";
+    return 0;
+}
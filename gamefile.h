@@ -0,0 +1,68 @@
+#ifndef GAMEFILE_H
+#define GAMEFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "chess.h"
+
+//A game file is GAME_FILE_MAGIC followed by games, each a GameHeader, the FEN of the starting position padded
+//to an even length (absent for the standard start) and then one Move per ply. Headers and moves are stored in the
+//byte order of the machine that wrote them.
+const char GAME_FILE_MAGIC[8] = {'C', 'H', 'S', 'G', 'A', 'M', 'E', '1'};
+
+const int RESULT_UNFINISHED = 0;
+const int RESULT_WHITE_WINS = 1;
+const int RESULT_BLACK_WINS = 2;
+const int RESULT_DRAW = 3;
+
+struct GameHeader{
+    uint32_t plies;
+    uint8_t result;
+    uint8_t fenLength; //0 for the standard starting position
+    uint16_t reserved;
+};
+
+//Appends games to a game file, writing the magic first if the file is new
+class GameWriter{
+private:
+    std::string path;
+public:
+    GameWriter(const std::string& path): path(path) {}
+    //Returns false if the file cannot be written
+    bool write(const std::string& startFen, const std::vector<Move>& moves, int result);
+};
+
+//A read-only view of a memory-mapped game file. Opening it walks the headers once to index the games,
+//after which any ply of any game is reached by replaying the stored moves.
+class GameArchive{
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<uint64_t> offsets; //Of each game's header
+    //Records are only 2-byte aligned, so headers and moves are copied out rather than read in place
+    GameHeader header(size_t game);
+public:
+    GameArchive() {}
+    GameArchive(const GameArchive&) = delete;
+    GameArchive& operator=(const GameArchive&) = delete;
+    ~GameArchive();
+    //Returns false if the file cannot be mapped or is not a game file
+    bool open(const std::string& path);
+    size_t gameCount() {return offsets.size();}
+    int plies(size_t game) {return header(game).plies;}
+    int result(size_t game) {return header(game).result;}
+    std::string startFen(size_t game);
+    //The stored move of a game at a ply below plies(game)
+    Move move(size_t game, int ply);
+    //Sets up the position after the first ply moves of a game, or the last position if the game is shorter.
+    //Every move is checked first with isLegalMove, a few table lookups next to making it. Returns false for a
+    //damaged game: an unreadable starting position, leaving the standard one, or an illegal move, leaving the
+    //position before it.
+    bool replay(size_t game, int ply, ChessBoard* chessBoard);
+};
+
+//Entry point for "chess games <file> [game] [ply]", prints one position or times replaying every game
+int gamesCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,221 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include "chess.h"
+#include "movegen.h"
+#include "perft.h"
+#include "analyze.h"
+#include "pgn.h"
+#include "gamefile.h"
+#include "uci.h"
+#include "server.h"
+#include "zobrist.h"
+#include "smp.h"
+#include "ponder.h"
+#include "tablebase.h"
+#include "book.h"
+#include "eval.h"
+#include "nnue.h"
+#include "match.h"
+#include "stats.h"
+
+//Removes "<option> <value>" from the command line and returns the value, empty when the option is not there
+static std::string takeOption(int& argc, char* argv[], const std::string& option){
+    for(int i = 1; i + 1 < argc; i++){
+        if(argv[i] == option){
+            std::string value = argv[i + 1];
+            for(int j = i; j + 2 <= argc; j++)
+                argv[j] = argv[j + 2];
+            argc -= 2;
+            return value;
+        }
+    }
+    return "";
+}
+
+int main(int argc, char* argv[])
+{
+    initBitboards();
+    initZobrist();
+    initEval();
+    //"--tablebases <directory>" anywhere on the command line maps the endgame tables in it, for every mode
+    std::string tablebasePath = takeOption(argc, argv, "--tablebases");
+    if(!tablebasePath.empty())
+        std::cerr<<loadTablebases(tablebasePath)<<" endgame tables loaded\n";
+    //"--network <file>" evaluates with a network (nnue.h) instead of the piece-square tables, for every mode
+    std::string networkPath = takeOption(argc, argv, "--network");
+    if(!networkPath.empty() && !loadNetwork(networkPath)){
+        std::cerr<<"Cannot read a network from "<<networkPath<<"\n";
+        return 1;
+    }
+    //"--stats <seconds>" writes the counters and latencies of stats.h to standard error that often, for every mode
+    std::string statsInterval = takeOption(argc, argv, "--stats");
+    if(!statsInterval.empty()){
+        if(!statsEnabled())
+            std::cerr<<statsText();
+        else
+            reportStatsEvery(atof(statsInterval.c_str()));
+    }
+    if(argc > 1 && std::string(argv[1]) == "tablebase")
+        return tablebaseCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "book")
+        return bookCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "eval")
+        return evalCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "perft")
+        return perftCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "match")
+        return matchCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "smp")
+        return scalingCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "analyze")
+        return analyzeCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "pgn")
+        return pgnCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "games")
+        return gamesCommand(argc, argv);
+    if(argc > 1 && std::string(argv[1]) == "uci")
+        return uciCommand();
+    if(argc > 1 && std::string(argv[1]) == "server")
+        return serverCommand(argc, argv);
+
+    //"--record <file>" anywhere on the command line appends the game to a game file when it ends
+    std::string recordPath = takeOption(argc, argv, "--record");
+    //"--book <file>" has the computer play from an opening book while the position is in it
+    OpeningBook book;
+    std::string bookPath = takeOption(argc, argv, "--book");
+    if(!bookPath.empty() && !book.open(bookPath))
+        std::cout<<"Cannot read a book from "<<bookPath<<"\n";
+    std::mt19937_64 random(std::random_device{}());
+    //"--ponder off" leaves the computer idle while the human thinks
+    bool pondering = (takeOption(argc, argv, "--ponder") != "off");
+
+    //"chess computer [white|black] [milliseconds] [threads]" lets the search play one side
+    int computer = 0, threads = 1;
+    SearchLimits limits;
+    limits.moveTime = 2000;
+    if(argc > 1 && std::string(argv[1]) == "computer"){
+        computer = (argc > 2 && std::string(argv[2]) == "white"? WHITE : BLACK);
+        if(argc > 3)
+            limits.moveTime = atoi(argv[3]);
+        if(argc > 4)
+            threads = atoi(argv[4]);
+    }
+
+    std::cout<<"Welcome to chess!\n"
+    <<"Pieces other than pawns are represented with two letters. The first is either q or k, indicating if it stands on the queen or king side of the board.\n"
+    <<"Uppercase first letters represent white's pieces, lowercase black's.\n"
+    <<"The second letter is one of the following: R, N, B, Q, or K for rook, knight, bishop, queen and king respectively.\n"
+    <<"Pawns are represented as P1 - P8 by the file they stand on, using the same capitalization scheme.\n"
+    <<"To move, enter the position of the piece you want to move, e.g. b5, using lowercase letters"
+    <<" followed after a space by the position you want the piece to move to.\n"
+    <<"As an example, white might make the opening move e2 e4.\n"
+    <<"Entering a position followed by a question mark, e.g. e2 ?, lists the moves of the piece there.\n"
+    <<"Castling is indicated from the king's point of view.\n"
+    <<"The game ends in checkmate, or in a draw by stalemate, insufficient material, the fifty-move rule or threefold repetition.\n";
+    ChessBoard* chessBoard = new ChessBoard();
+    std::string src, dest;
+    newGame(chessBoard);
+    //Keys of every position reached, for recognising a threefold repetition
+    std::vector<uint64_t> history(1, chessBoard->getKey());
+    std::vector<Move> moves;
+    int result = RESULT_UNFINISHED;
+    TranspositionTable tt(64);
+    //Destroyed before the table its search uses
+    Ponderer ponderer;
+    //Worked out once a position, when its status is checked, and then used to check every move typed in it
+    LegalMoveCache legal;
+    while(true){
+        int turn = chessBoard->getTurn();
+        printBoard(turn, chessBoard);
+        Move bookMove = (turn == computer && book.isOpen()? book.pick(chessBoard, random()) : NO_MOVE);
+        if(bookMove != NO_MOVE){
+            ponderer.cancel();
+            UndoRecord undo;
+            chessBoard->makeMove(bookMove, undo);
+            moves.push_back(bookMove);
+            std::cout<<"The computer plays "<<moveToString(bookMove)<<" from the book\n";
+        }
+        else if(turn == computer){
+            SearchReport pondered;
+            Move best = (ponderer.isPondering()? ponderer.finish(moves.back(), pondered) : NO_MOVE);
+            if(best != NO_MOVE){
+                std::cout<<"The computer expected "<<moveToString(moves.back())<<"\n";
+                if(pondered.depth > 0)
+                    std::cout<<formatReport(pondered)<<"\n";
+            }
+            else{
+                ParallelSearch search(chessBoard, tt, history, threads);
+                search.onIteration = [](const SearchReport& report){std::cout<<formatReport(report)<<"\n";};
+                best = search.run(limits);
+            }
+            if(best == NO_MOVE){
+                std::cout<<"The computer has no legal move\n";
+                if(!chessBoard->inCheck())
+                    result = RESULT_DRAW;
+                break;
+            }
+            UndoRecord undo;
+            chessBoard->makeMove(best, undo);
+            moves.push_back(best);
+            std::cout<<"The computer plays "<<moveToString(best)<<"\n";
+        }
+        else{
+            if(computer != 0 && pondering && !ponderer.isPondering())
+                ponderer.start(chessBoard, history, tt, threads, limits);
+            if(!(std::cin>>src>>dest))
+                break;
+            if(dest == "?" && onBoard(src)){
+                legal.update(chessBoard);
+                std::cout<<moveHint(src[0] - 'a' + (src[1] - '1') * 8, legal)<<"\n";
+                continue;
+            }
+            int srcPos = src[0] - 'a' + ((src[1] - '0') - 1) * 8;
+            int destPos = dest[0] - 'a' + ((dest[1] - '0') - 1) * 8;
+            if(!onBoard(src) || !onBoard(dest)){
+                std::cout<<"Invalid address entered\n";
+                continue;
+            }
+            if(srcPos == destPos || chessBoard->getBoard()[srcPos] == NO_PIECE){
+                std::cout<<"A piece must move every turn\n";
+                continue;
+            }
+            Move played;
+            if(!playMove(chessBoard, srcPos, destPos, turn, legal, &played))
+                continue;
+            moves.push_back(played);
+        }
+        int status = gameStatus(chessBoard, legal);
+        if(status == STATUS_CHECKMATE){
+            std::cout<<(turn == WHITE? "WHITE" : "BLACK")<<" WINS!\n";
+            result = (turn == WHITE? RESULT_WHITE_WINS : RESULT_BLACK_WINS);
+            break;
+        }
+        if(status != STATUS_PLAYING){
+            std::cout<<"The game is a draw by "<<statusName(status)<<".\n";
+            result = RESULT_DRAW;
+            break;
+        }
+        history.push_back(chessBoard->getKey());
+        if(countRepetitions(history, chessBoard->getHalfmoveClock()) >= 2){
+            std::cout<<"The same position has occurred three times. The game is a draw.\n";
+            result = RESULT_DRAW;
+            break;
+        }
+        //Once the endgame tables know the result there is nothing left to play for
+        TablebaseResult known;
+        if(chessBoard->probeTablebase(known)){
+            std::cout<<"The endgame tables adjudicate the game: "<<describeResult(chessBoard, known)<<".\n";
+            if(known.outcome == 0)
+                result = RESULT_DRAW;
+            else
+                result = ((known.outcome > 0) == (chessBoard->getTurn() == WHITE)? RESULT_WHITE_WINS : RESULT_BLACK_WINS);
+            break;
+        }
+    }
+    if(!recordPath.empty() && !GameWriter(recordPath).write("", moves, result))
+        std::cout<<"Cannot write the game to "<<recordPath<<"\n";
+    return 0;
+}
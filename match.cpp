@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "match.h"
+#include "fen.h"
+#include "pgn.h"
+#include "zobrist.h"
+#include "nnue.h"
+#include "tablebase.h"
+
+//Balanced lines of the main openings, used when no openings file is given. Each is played twice, once with
+//each engine as white.
+static const char* builtinOpenings[] = {
+    "e4 e5 Nf3 Nc6 Bb5 a6",
+    "e4 e5 Nf3 Nc6 Bc4 Bc5",
+    "e4 e5 Nf3 Nc6 d4 exd4 Nxd4",
+    "e4 e5 Nf3 Nf6 Nxe5 d6 Nf3 Nxe4",
+    "e4 c5 Nf3 d6 d4 cxd4 Nxd4 Nf6 Nc3 a6",
+    "e4 c5 Nf3 Nc6 d4 cxd4 Nxd4",
+    "e4 e6 d4 d5 Nc3 Nf6",
+    "e4 c6 d4 d5 e5 Bf5",
+    "e4 d5 exd5 Qxd5 Nc3 Qa5",
+    "e4 g6 d4 Bg7 Nc3 d6",
+    "d4 d5 c4 e6 Nc3 Nf6",
+    "d4 d5 c4 c6 Nf3 Nf6",
+    "d4 d5 c4 dxc4 Nf3 Nf6 e3 e6",
+    "d4 Nf6 c4 e6 Nc3 Bb4",
+    "d4 Nf6 c4 g6 Nc3 Bg7 e4 d6",
+    "d4 Nf6 c4 c5 d5 b5",
+    "d4 f5 g3 Nf6 Bg2 e6",
+    "c4 e5 Nc3 Nf6",
+    "c4 c5 Nc3 Nc6 g3 g6 Bg2 Bg7",
+    "Nf3 d5 g3 Nf6 Bg2",
+};
+
+bool parseEngine(const std::string& text, EngineSettings& settings, std::string& error){
+    settings = EngineSettings();
+    bool limited = false;
+    std::istringstream fields(text);
+    std::string field;
+    while(std::getline(fields, field, ',')){
+        size_t equals = field.find('=');
+        std::string key = field.substr(0, equals), value = (equals == std::string::npos? "" : field.substr(equals + 1));
+        long long number = atoll(value.c_str());
+        if(key == "eval" && (value == "network" || value == "pst"))
+            settings.network = (value == "network");
+        else if(key == "depth" && number > 0 && number < MAX_PLY)
+            settings.limits.depth = int(number);
+        else if(key == "nodes" && number > 0)
+            settings.limits.nodes = uint64_t(number);
+        else if(key == "time" && number > 0)
+            settings.limits.moveTime = number;
+        else if(key == "hash" && number > 0)
+            settings.hash = size_t(number);
+        else{
+            error = "cannot read \"" + field + "\"";
+            return false;
+        }
+        limited = limited || key == "depth" || key == "nodes" || key == "time";
+    }
+    //A search without any limit would never end
+    if(!limited)
+        settings.limits.nodes = 10000;
+    return true;
+}
+
+double eloDifference(const MatchScore& score){
+    if(score.games() == 0)
+        return 0;
+    double points = (score.wins + score.draws / 2.0) / score.games();
+    //A clean sweep has no finite difference, it is shown as the one for missing half a point
+    double limit = 0.5 / score.games();
+    points = std::min(std::max(points, limit), 1 - limit);
+    return 400 * std::log10(points / (1 - points));
+}
+
+//Mean and variance of the points of one game
+static void scoreMoments(const MatchScore& score, double& mean, double& variance){
+    int games = score.games();
+    mean = (score.wins + score.draws / 2.0) / games;
+    variance = (score.wins * (1 - mean) * (1 - mean) + score.draws * (0.5 - mean) * (0.5 - mean) + score.losses * mean * mean) / games;
+}
+
+double eloMargin(const MatchScore& score){
+    if(score.games() < 2)
+        return 0;
+    double mean, variance;
+    scoreMoments(score, mean, variance);
+    double deviation = 1.96 * std::sqrt(variance / score.games());
+    auto elo = [](double points){
+        points = std::min(std::max(points, 1e-6), 1 - 1e-6);
+        return 400 * std::log10(points / (1 - points));
+    };
+    return (elo(mean + deviation) - elo(mean - deviation)) / 2;
+}
+
+double sprtLlr(const MatchScore& score, double elo0, double elo1){
+    if(score.games() == 0)
+        return 0;
+    double mean, variance;
+    scoreMoments(score, mean, variance);
+    if(variance <= 0)
+        return 0;
+    double expected0 = 1 / (1 + std::pow(10, -elo0 / 400)), expected1 = 1 / (1 + std::pow(10, -elo1 / 400));
+    return score.games() * (expected1 - expected0) * (2 * mean - expected0 - expected1) / (2 * variance);
+}
+
+double sprtLower(double alpha, double beta){
+    return std::log(beta / (1 - alpha));
+}
+
+double sprtUpper(double alpha, double beta){
+    return std::log((1 - beta) / alpha);
+}
+
+//A starting position and the keys of the moves that led to it, for spotting repetitions
+struct Opening{
+    ChessBoard board;
+    std::vector<uint64_t> keys;
+};
+
+//An opening that cannot be set up is left out with a message naming it, rather than played from a broken position
+static bool loadOpenings(const std::string& path, std::vector<Opening>& openings){
+    if(path.empty() || path == "-"){
+        for(const char* line: builtinOpenings){
+            Opening opening;
+            newGame(&opening.board);
+            opening.keys.assign(1, opening.board.getKey());
+            std::istringstream moves(line);
+            std::string san, error;
+            bool playable = true;
+            while(moves>>san){
+                Move move = parseSan(&opening.board, san, &error);
+                if(move == NO_MOVE){
+                    std::cout<<"Skipping built-in opening \""<<line<<"\": "<<san<<": "<<error<<"\n";
+                    playable = false;
+                    break;
+                }
+                UndoRecord undo;
+                opening.board.makeMove(move, undo);
+                opening.keys.push_back(opening.board.getKey());
+            }
+            if(playable)
+                openings.push_back(opening);
+        }
+        return !openings.empty();
+    }
+    std::ifstream input(path);
+    std::string line;
+    int number = 0;
+    while(std::getline(input, line)){
+        number++;
+        Opening opening;
+        if(line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        if(!setupPosition(&opening.board, line)){
+            std::cout<<"Skipping line "<<number<<" of "<<path<<", not a position: "<<line<<"\n";
+            continue;
+        }
+        opening.keys.assign(1, opening.board.getKey());
+        openings.push_back(opening);
+    }
+    return !openings.empty();
+}
+
+//Everything one thread needs to play games. It is set up once and every game starts by copying an opening
+//over the same board, so playing a game allocates nothing beyond the searches' own vectors.
+struct MatchWorker{
+    ChessBoard board;
+    std::vector<uint64_t> keys;
+    std::vector<std::unique_ptr<TranspositionTable>> tables;
+};
+
+//Plays one game and returns 1 if the first engine wins, -1 if it loses and 0 for a draw
+static int playGame(MatchWorker& worker, const Opening& opening, const EngineSettings engines[2], bool firstIsWhite){
+    ChessBoard& board = worker.board;
+    board = opening.board;
+    worker.keys = opening.keys;
+    for(auto& table: worker.tables)
+        table->clear();
+    while(true){
+        //Engine 0 is the first engine
+        int engine = ((board.getTurn() == WHITE) == firstIsWhite? 0 : 1);
+        Search search(&board, *worker.tables[engine], worker.keys);
+        if(!engines[engine].network)
+            search.usePieceSquare();
+        worker.tables[engine]->newSearch();
+        Move best = search.run(engines[engine].limits);
+        //Only an opening from a file can already be over
+        if(best == NO_MOVE)
+            return !board.inCheck()? 0 : engine == 0? -1 : 1;
+        UndoRecord undo;
+        board.makeMove(best, undo);
+        worker.keys.push_back(board.getKey());
+
+        int status = gameStatus(&board);
+        if(status == STATUS_CHECKMATE)
+            return engine == 0? 1 : -1;
+        if(status != STATUS_PLAYING || countRepetitions(worker.keys, board.getHalfmoveClock()) >= 2)
+            return 0;
+        TablebaseResult known;
+        if(board.probeTablebase(known)){
+            if(known.outcome == 0)
+                return 0;
+            //The outcome is for the side to move, the engine that has just moved is the other one
+            return (known.outcome < 0) == (engine == 0)? 1 : -1;
+        }
+    }
+}
+
+int matchCommand(int argc, char* argv[]){
+    EngineSettings engines[2];
+    std::string error;
+    if(argc < 4 || !parseEngine(argv[2], engines[0], error) || !parseEngine(argv[3], engines[1], error)){
+        if(!error.empty())
+            std::cout<<"Invalid engine: "<<error<<"\n";
+        std::cout<<"Usage: chess match <engine> <engine> [games] [threads] [openings file|-] [elo0] [elo1]\n"
+        <<"An engine is a list such as nodes=20000,eval=pst with keys depth, nodes, time, hash and eval (network or pst)\n";
+        return 1;
+    }
+    int games = (argc > 4? atoi(argv[4]) : 1000);
+    int threads = (argc > 5? atoi(argv[5]) : int(std::thread::hardware_concurrency()));
+    std::string openingsPath = (argc > 6? argv[6] : "-");
+    double elo0 = (argc > 7? atof(argv[7]) : 0), elo1 = (argc > 8? atof(argv[8]) : 5);
+    if(games < 1 || threads < 1){
+        std::cout<<"The number of games and threads must be positive\n";
+        return 1;
+    }
+    if((engines[0].network || engines[1].network) && !networkLoaded())
+        engines[0].network = engines[1].network = false;
+    std::vector<Opening> openings;
+    if(!loadOpenings(openingsPath, openings)){
+        std::cout<<"Cannot read openings from "<<openingsPath<<"\n";
+        return 1;
+    }
+
+    std::vector<MatchWorker> workers(threads);
+    for(MatchWorker& worker: workers){
+        for(const EngineSettings& engine: engines)
+            worker.tables.emplace_back(new TranspositionTable(engine.hash));
+    }
+
+    const double lower = sprtLower(0.05, 0.05), upper = sprtUpper(0.05, 0.05);
+    const int reportEvery = std::max(1, games / 20);
+    MatchScore score;
+    std::mutex scoreLock;
+    //Set once the test has decided, games still being played are counted but no new ones start
+    std::atomic<bool> decided{false};
+    std::atomic<int> next{0};
+    auto start = std::chrono::steady_clock::now();
+    auto report = [&](){
+        double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 3600;
+        std::cout<<std::fixed<<std::setprecision(1)<<"games "<<score.games()<<" +"<<score.wins<<" -"<<score.losses<<" ="<<score.draws
+        <<" elo "<<eloDifference(score)<<" +- "<<eloMargin(score)
+        <<std::setprecision(2)<<" llr "<<sprtLlr(score, elo0, elo1)<<" ("<<lower<<", "<<upper<<") "
+        <<uint64_t(score.games() / (hours > 0? hours : 1e-9))<<" games/hour\n"<<std::defaultfloat<<std::setprecision(6);
+    };
+
+    std::cout<<openings.size()<<" openings, "<<threads<<" threads, testing elo0 "<<elo0<<" against elo1 "<<elo1<<"\n";
+    auto work = [&](MatchWorker& worker){
+        for(int game = next++; game < games && !decided.load(); game = next++){
+            //Both engines play each opening once with white, one after the other
+            int result = playGame(worker, openings[(game / 2) % openings.size()], engines, game % 2 == 0);
+            std::lock_guard<std::mutex> guard(scoreLock);
+            (result > 0? score.wins : result < 0? score.losses : score.draws)++;
+            double llr = sprtLlr(score, elo0, elo1);
+            if(llr >= upper || llr <= lower)
+                decided.store(true);
+            if(score.games() % reportEvery == 0)
+                report();
+        }
+    };
+    std::vector<std::thread> pool;
+    for(int i = 1; i < threads; i++)
+        pool.emplace_back(work, std::ref(workers[i]));
+    work(workers[0]);
+    for(std::thread& thread: pool)
+        thread.join();
+
+    if(score.games() % reportEvery != 0)
+        report();
+    double llr = sprtLlr(score, elo0, elo1);
+    if(llr >= upper)
+        std::cout<<"H1 accepted: the first engine is at least "<<elo1<<" Elo stronger\n";
+    else if(llr <= lower)
+        std::cout<<"H0 accepted: the first engine is not more than "<<elo0<<" Elo stronger\n";
+    else
+        std::cout<<"No decision after "<<score.games()<<" games\n";
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef MATCH_H
+#define MATCH_H
+
+#include <string>
+#include "search.h"
+
+//How one side of a match searches, parsed from e.g. "nodes=20000,eval=pst"
+struct EngineSettings{
+    SearchLimits limits;
+    size_t hash = 16; //Megabytes
+    bool network = true; //Evaluates with the loaded network if there is one
+};
+//Keys are depth, nodes, time (milliseconds per move), hash and eval (network or pst).
+//Returns false with the reason in error when the description cannot be read.
+bool parseEngine(const std::string& text, EngineSettings& settings, std::string& error);
+
+//Games won, lost and drawn by the first engine of a match
+struct MatchScore{
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+    int games() const {return wins + losses + draws;}
+};
+//The logistic Elo difference the score stands for, and the half width of its 95% confidence interval
+double eloDifference(const MatchScore& score);
+double eloMargin(const MatchScore& score);
+//Log-likelihood ratio of the first engine being elo1 stronger against it being elo0 stronger, using a normal
+//approximation of the game results. The test passes above sprtUpper and fails below sprtLower.
+double sprtLlr(const MatchScore& score, double elo0, double elo1);
+double sprtLower(double alpha, double beta);
+double sprtUpper(double alpha, double beta);
+
+//Entry point for "chess match <engine> <engine> [games] [threads] [openings] [elo0] [elo1]", plays the engines against
+//each other on every core until the games run out or the sequential probability ratio test decides
+int matchCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+
+//A move packed into 16 bits: the source square in bits 0-5, the destination in bits 6-11 and a flag in bits 12-15
+typedef uint16_t Move;
+
+const int MOVE_NORMAL = 0;
+const int MOVE_CASTLING = 1;
+const int MOVE_EN_PASSANT = 2;
+//Promotions are MOVE_PROMOTION plus the offset of the new piece type from KNIGHT
+const int MOVE_PROMOTION = 4;
+
+const Move NO_MOVE = 0;
+
+inline Move encodeMove(int source, int destination, int flag = MOVE_NORMAL) {return Move(source | destination << 6 | flag << 12);}
+inline int moveFrom(Move move) {return move & 63;}
+inline int moveTo(Move move) {return (move >> 6) & 63;}
+inline int moveFlag(Move move) {return move >> 12;}
+inline bool isPromotion(Move move) {return moveFlag(move) >= MOVE_PROMOTION;}
+//The piece type promoted to, counting types in the order of chess.h (KNIGHT is 1)
+inline int promotionType(Move move) {return moveFlag(move) - MOVE_PROMOTION + 1;}
+
+//Coordinate notation as typed in the game loop, e.g. e2e4 or e7e8q
+inline std::string moveToString(Move move){
+    std::string text;
+    text += char('a' + moveFrom(move) % 8);
+    text += char('1' + moveFrom(move) / 8);
+    text += char('a' + moveTo(move) % 8);
+    text += char('1' + moveTo(move) / 8);
+    if(isPromotion(move))
+        text += "nbrq"[promotionType(move) - 1];
+    return text;
+}
+
+//The most legal moves known in any position is 218, so a fixed array never overflows
+struct MoveList{
+    Move moves[256];
+    int count = 0;
+    void add(Move move) {moves[count++] = move;}
+    Move* begin() {return moves;}
+    Move* end() {return moves + count;}
+    int size() const {return count;}
+};
+
+#endif
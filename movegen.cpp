@@ -0,0 +1,264 @@
+#include "movegen.h"
+
+static void addPawnMoves(MoveList& list, int source, int destination){
+    if(destination / 8 == 0 || destination / 8 == 7){
+        for(int type = QUEEN; type >= KNIGHT; type--)
+            list.add(encodeMove(source, destination, MOVE_PROMOTION + type - KNIGHT));
+    }
+    else
+        list.add(encodeMove(source, destination));
+}
+
+//En passant removes two pieces from one rank, which can uncover a slider on the king in a way pins do not catch,
+//so the resulting position is tested directly
+static bool enpassantIsLegal(ChessBoard* chessBoard, int color, int source, int destination, int kingPos){
+    int captured = destination - 8 * color;
+    Bitboard occupied = (chessBoard->getOccupancy() ^ squareBB(source) ^ squareBB(captured)) | squareBB(destination);
+    return !(chessBoard->attackersTo(kingPos, color * -1, occupied) & ~squareBB(captured));
+}
+
+//A castling right means the king and that castle have never moved, so only the path needs checking
+static void generateCastling(ChessBoard* chessBoard, int color, MoveList& list){
+    int home = (color == WHITE? 4 : 60);
+    for(int moveDir = -1; moveDir <= 1; moveDir += 2){
+        int castlePos = (moveDir == 1? home + 3 : home - 4);
+        int right = (moveDir == 1? WHITE_KINGSIDE : WHITE_QUEENSIDE) << (color == WHITE? 0 : 2);
+        if(!(chessBoard->getCastlingRights() & right))
+            continue;
+        if(betweenMask[home][castlePos] & chessBoard->getOccupancy())
+            continue;
+        //The squares the king crosses and lands on, its own square is safe as castling is never tried in check
+        if(!(chessBoard->getAttacked() & betweenMask[home][home + 3 * moveDir]))
+            list.add(encodeMove(home, home + 2 * moveDir, MOVE_CASTLING));
+    }
+}
+
+void generateLegalMoves(ChessBoard* chessBoard, MoveList& list, bool capturesOnly){
+    int color = chessBoard->getTurn();
+    Bitboard own = chessBoard->getColorPieces(color);
+    Bitboard enemy = chessBoard->getColorPieces(color * -1);
+    Bitboard occupied = chessBoard->getOccupancy();
+    int kingPos = lsb(chessBoard->getPieces(color, KING));
+    Bitboard checkers = chessBoard->getCheckers();
+
+    //The attacked squares already look through the king, so it cannot hide behind itself
+    Bitboard kingTargets = kingAttacks[kingPos] & (capturesOnly? enemy : ~own) & ~chessBoard->getAttacked();
+    while(kingTargets)
+        list.add(encodeMove(kingPos, popLsb(kingTargets)));
+    if(moreThanOne(checkers))
+        return;
+
+    //Out of check every other move has to capture the checker or land between it and the king
+    Bitboard targets = ~own;
+    if(checkers)
+        targets = checkers | betweenMask[kingPos][lsb(checkers)];
+    else if(!capturesOnly)
+        generateCastling(chessBoard, color, list);
+    Bitboard quietTargets = targets;
+    if(capturesOnly)
+        targets &= enemy;
+    Bitboard pinned = chessBoard->getPinned();
+
+    for(int type = KNIGHT; type <= QUEEN; type++){
+        Bitboard pieces = chessBoard->getPieces(color, type);
+        while(pieces){
+            int source = popLsb(pieces);
+            Bitboard attacks;
+            if(type == KNIGHT)
+                attacks = knightAttacks[source];
+            else if(type == BISHOP)
+                attacks = bishopAttacks(source, occupied);
+            else if(type == ROOK)
+                attacks = rookAttacks(source, occupied);
+            else
+                attacks = queenAttacks(source, occupied);
+            attacks &= targets;
+            if(pinned & squareBB(source))
+                attacks &= lineMask[kingPos][source];
+            while(attacks)
+                list.add(encodeMove(source, popLsb(attacks)));
+        }
+    }
+
+    Bitboard pawns = chessBoard->getPieces(color, PAWN);
+    Bitboard startRank = (color == WHITE? RANK_1 << 8 : RANK_8 >> 8);
+    int enpassantSquare = chessBoard->getEnpassantSquare();
+    while(pawns){
+        int source = popLsb(pawns);
+        Bitboard allowed = targets, pushes = quietTargets;
+        if(pinned & squareBB(source)){
+            allowed &= lineMask[kingPos][source];
+            pushes &= lineMask[kingPos][source];
+        }
+
+        //With captures only, pushes are still generated when they promote
+        int single = source + 8 * color;
+        if(!(occupied & squareBB(single))){
+            bool promoting = (single / 8 == 0 || single / 8 == 7);
+            if((pushes & squareBB(single)) && (promoting || !capturesOnly))
+                addPawnMoves(list, source, single);
+            int twice = single + 8 * color;
+            if(!capturesOnly && (startRank & squareBB(source)) && !(occupied & squareBB(twice)) && (pushes & squareBB(twice)))
+                list.add(encodeMove(source, twice));
+        }
+
+        Bitboard captures = pawnAttacks[colorIndex(color)][source] & enemy & allowed;
+        while(captures)
+            addPawnMoves(list, source, popLsb(captures));
+
+        if(enpassantSquare >= 0 && (pawnAttacks[colorIndex(color)][source] & squareBB(enpassantSquare))
+        && enpassantIsLegal(chessBoard, color, source, enpassantSquare, kingPos))
+            list.add(encodeMove(source, enpassantSquare, MOVE_EN_PASSANT));
+    }
+}
+
+bool hasLegalMove(ChessBoard* chessBoard){
+    int color = chessBoard->getTurn(), kingPos = chessBoard->kingSquare(color);
+    Bitboard own = chessBoard->getColorPieces(color), enemy = chessBoard->getColorPieces(color * -1);
+    Bitboard occupied = chessBoard->getOccupancy();
+    //King moves come first as the squares the enemy attacks are already known
+    if(kingAttacks[kingPos] & ~own & ~chessBoard->getAttacked())
+        return true;
+    Bitboard checkers = chessBoard->getCheckers();
+    if(moreThanOne(checkers)) //Only the king can answer a double check
+        return false;
+    Bitboard pinned = chessBoard->getPinned();
+    Bitboard unpinned = own & ~chessBoard->getPieces(color, KING) & ~pinned;
+    Bitboard pawns = chessBoard->getPieces(color, PAWN) & unpinned;
+
+    if(checkers){
+        //A pinned piece can neither capture the checker nor block it, so it is never a defender
+        int checker = lsb(checkers);
+        if(chessBoard->attackersTo(checker, color) & unpinned)
+            return true;
+        //Interposing on the checking ray, where pawns block by pushing rather than by capturing
+        Bitboard blocks = betweenMask[kingPos][checker];
+        Bitboard singles = (color == WHITE? pawns << 8 : pawns >> 8) & ~occupied;
+        Bitboard doubles = (color == WHITE? (singles & RANK_1 << 16) << 8 : (singles & RANK_8 >> 16) >> 8) & ~occupied;
+        if((singles | doubles) & blocks)
+            return true;
+        while(blocks){
+            if(chessBoard->attackersTo(popLsb(blocks), color) & unpinned & ~pawns)
+                return true;
+        }
+        //En passant can take a checking pawn or land on the ray, and may uncover a check of its own
+        if(chessBoard->getEnpassantSquare() < 0)
+            return false;
+    }
+    else{
+        Bitboard pieces = chessBoard->getPieces(color, KNIGHT) & unpinned;
+        while(pieces){
+            if(knightAttacks[popLsb(pieces)] & ~own)
+                return true;
+        }
+        pieces = (chessBoard->getPieces(color, BISHOP) | chessBoard->getPieces(color, QUEEN)) & unpinned;
+        while(pieces){
+            if(bishopAttacks(popLsb(pieces), occupied) & ~own)
+                return true;
+        }
+        pieces = (chessBoard->getPieces(color, ROOK) | chessBoard->getPieces(color, QUEEN)) & unpinned;
+        while(pieces){
+            if(rookAttacks(popLsb(pieces), occupied) & ~own)
+                return true;
+        }
+        if((color == WHITE? pawns << 8 : pawns >> 8) & ~occupied)
+            return true;
+        while(pawns){
+            if(pawnAttacks[colorIndex(color)][popLsb(pawns)] & enemy)
+                return true;
+        }
+    }
+
+    //What is left is rare: pinned pieces moving along their pin, and en passant
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    return list.size() > 0;
+}
+
+//Asks the generator's questions of the one move, so checking a move costs a few table lookups rather than a
+//generation. Castling is rare enough to be generated and searched for.
+bool isLegalMove(ChessBoard* chessBoard, Move move){
+    int color = chessBoard->getTurn(), source = moveFrom(move), destination = moveTo(move), flag = moveFlag(move);
+    Piece moving = chessBoard->getBoard()[source];
+    Bitboard own = chessBoard->getColorPieces(color), occupied = chessBoard->getOccupancy();
+    if(moving == NO_PIECE || pieceColor(moving) != color || (own & squareBB(destination)))
+        return false;
+    int type = pieceType(moving), kingPos = chessBoard->kingSquare(color);
+    Bitboard checkers = chessBoard->getCheckers();
+
+    if(type == KING){
+        if(flag == MOVE_CASTLING && !checkers){
+            MoveList list;
+            generateCastling(chessBoard, color, list);
+            for(Move castling: list){
+                if(castling == move)
+                    return true;
+            }
+            return false;
+        }
+        return flag == MOVE_NORMAL && (kingAttacks[source] & squareBB(destination)) && !chessBoard->isAttacked(destination);
+    }
+    if(moreThanOne(checkers))
+        return false;
+
+    if(type == PAWN){
+        if(flag == MOVE_EN_PASSANT)
+            return destination == chessBoard->getEnpassantSquare() && (pawnAttacks[colorIndex(color)][source] & squareBB(destination))
+            && enpassantIsLegal(chessBoard, color, source, destination, kingPos);
+        bool promoting = (destination / 8 == 0 || destination / 8 == 7);
+        if(promoting? !(isPromotion(move) && promotionType(move) <= QUEEN) : flag != MOVE_NORMAL)
+            return false;
+        Bitboard startRank = (color == WHITE? RANK_1 << 8 : RANK_8 >> 8);
+        bool reaches;
+        if(destination == source + 8 * color)
+            reaches = !(occupied & squareBB(destination));
+        else if(destination == source + 16 * color)
+            reaches = (startRank & squareBB(source)) && !(occupied & (squareBB(destination) | squareBB(source + 8 * color)));
+        else
+            reaches = (pawnAttacks[colorIndex(color)][source] & chessBoard->getColorPieces(color * -1) & squareBB(destination)) != 0;
+        if(!reaches)
+            return false;
+    }
+    else{
+        Bitboard attacks;
+        if(type == KNIGHT)
+            attacks = knightAttacks[source];
+        else if(type == BISHOP)
+            attacks = bishopAttacks(source, occupied);
+        else if(type == ROOK)
+            attacks = rookAttacks(source, occupied);
+        else
+            attacks = queenAttacks(source, occupied);
+        if(flag != MOVE_NORMAL || !(attacks & squareBB(destination)))
+            return false;
+    }
+
+    //Out of check the move has to capture the checker or land between it and the king, and a pinned piece stays on its pin
+    if(checkers && !((checkers | betweenMask[kingPos][lsb(checkers)]) & squareBB(destination)))
+        return false;
+    return !chessBoard->isPinned(source) || (lineMask[kingPos][source] & squareBB(destination));
+}
+
+void LegalMoveCache::update(ChessBoard* chessBoard){
+    if(valid && key == chessBoard->getKey())
+        return;
+    moves.count = 0;
+    generateLegalMoves(chessBoard, moves);
+    for(Bitboard& mask: destinations)
+        mask = 0;
+    for(Move move: moves)
+        destinations[moveFrom(move)] |= squareBB(moveTo(move));
+    key = chessBoard->getKey();
+    valid = true;
+}
+
+Move LegalMoveCache::find(int source, int destination, int promotion) const{
+    if(!allows(source, destination))
+        return NO_MOVE;
+    for(int i = 0; i < moves.size(); i++){
+        Move move = moves.moves[i];
+        if(moveFrom(move) == source && moveTo(move) == destination && (!isPromotion(move) || promotionType(move) == promotion))
+            return move;
+    }
+    return NO_MOVE;
+}
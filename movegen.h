@@ -0,0 +1,37 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "chess.h"
+#include "move.h"
+
+//Writes every legal move for the side to move into list, including castling, en passant and all four promotions.
+//With capturesOnly set, only captures and promotions are written.
+void generateLegalMoves(ChessBoard* chessBoard, MoveList& list, bool capturesOnly = false);
+//Whether the side to move has any legal move, stopping at the first one found. King moves and answers to a check
+//are tried first, the full generator is only needed for pinned pieces and en passant.
+bool hasLegalMove(ChessBoard* chessBoard);
+//Whether a move from outside, e.g. read from a file, is one of the side to move's legal moves
+bool isLegalMove(ChessBoard* chessBoard, Move move);
+
+//The legal moves of one position with a mask of destinations for every source square, worked out once a turn.
+//Checking a typed move is then a bit test, hints are a lookup, and an empty cache means the game is over.
+//update only generates moves when the board's position differs from the one cached, so every caller in a
+//turn can share one cache.
+class LegalMoveCache{
+private:
+    uint64_t key = 0;
+    bool valid = false;
+    MoveList moves;
+    Bitboard destinations[64];
+public:
+    void update(ChessBoard* chessBoard);
+    //Forces the next update to generate, e.g. after a board was set up in place with the same key
+    void invalidate() {valid = false;}
+    int count() const {return moves.size();}
+    Bitboard from(int source) const {return destinations[source];}
+    bool allows(int source, int destination) const {return (destinations[source] & squareBB(destination)) != 0;}
+    //The move from source to destination, promoting to the given type when it is a promotion; NO_MOVE when illegal
+    Move find(int source, int destination, int promotion = QUEEN) const;
+};
+
+#endif
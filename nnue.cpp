@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include "nnue.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+//The network is only written before searches start, so every thread reads it without locking
+static std::unique_ptr<Network> network;
+
+//Kernels work on whole rows of NNUE_HIDDEN values. update writes in plus the added rows minus the removed ones to out,
+//which may be in. output is the dot product of both clipped halves of the hidden layer with the output weights.
+typedef void (*UpdateKernel)(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount, const int16_t* const removed[], int removedCount);
+typedef int32_t (*OutputKernel)(const int16_t* us, const int16_t* them, const int16_t* weights);
+
+static void updateScalar(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount, const int16_t* const removed[], int removedCount){
+    for(int i = 0; i < NNUE_HIDDEN; i++){
+        int value = in[i];
+        for(int a = 0; a < addedCount; a++)
+            value += added[a][i];
+        for(int r = 0; r < removedCount; r++)
+            value -= removed[r][i];
+        out[i] = int16_t(value);
+    }
+}
+
+static int32_t outputScalar(const int16_t* us, const int16_t* them, const int16_t* weights){
+    int32_t sum = 0;
+    for(int i = 0; i < NNUE_HIDDEN; i++){
+        sum += std::min(std::max(int(us[i]), 0), NNUE_QA) * weights[i];
+        sum += std::min(std::max(int(them[i]), 0), NNUE_QA) * weights[NNUE_HIDDEN + i];
+    }
+    return sum;
+}
+
+#ifdef NNUE_X86
+//The vector kernels are compiled for their instruction sets whatever the build flags, and only called once
+//simdSupported has checked the processor runs them
+__attribute__((target("sse2")))
+static void updateSse2(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount, const int16_t* const removed[], int removedCount){
+    for(int i = 0; i < NNUE_HIDDEN; i += 8){
+        __m128i value = _mm_load_si128((const __m128i*)(in + i));
+        for(int a = 0; a < addedCount; a++)
+            value = _mm_add_epi16(value, _mm_load_si128((const __m128i*)(added[a] + i)));
+        for(int r = 0; r < removedCount; r++)
+            value = _mm_sub_epi16(value, _mm_load_si128((const __m128i*)(removed[r] + i)));
+        _mm_store_si128((__m128i*)(out + i), value);
+    }
+}
+
+__attribute__((target("sse2")))
+static int32_t outputSse2(const int16_t* us, const int16_t* them, const int16_t* weights){
+    const __m128i zero = _mm_setzero_si128(), ceiling = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = _mm_setzero_si128();
+    for(int i = 0; i < NNUE_HIDDEN; i += 8){
+        __m128i clipped = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(us + i)), zero), ceiling);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(clipped, _mm_load_si128((const __m128i*)(weights + i))));
+        clipped = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(them + i)), zero), ceiling);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(clipped, _mm_load_si128((const __m128i*)(weights + NNUE_HIDDEN + i))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx2")))
+static void updateAvx2(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount, const int16_t* const removed[], int removedCount){
+    for(int i = 0; i < NNUE_HIDDEN; i += 16){
+        __m256i value = _mm256_load_si256((const __m256i*)(in + i));
+        for(int a = 0; a < addedCount; a++)
+            value = _mm256_add_epi16(value, _mm256_load_si256((const __m256i*)(added[a] + i)));
+        for(int r = 0; r < removedCount; r++)
+            value = _mm256_sub_epi16(value, _mm256_load_si256((const __m256i*)(removed[r] + i)));
+        _mm256_store_si256((__m256i*)(out + i), value);
+    }
+}
+
+__attribute__((target("avx2")))
+static int32_t outputAvx2(const int16_t* us, const int16_t* them, const int16_t* weights){
+    const __m256i zero = _mm256_setzero_si256(), ceiling = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for(int i = 0; i < NNUE_HIDDEN; i += 16){
+        __m256i clipped = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(us + i)), zero), ceiling);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(clipped, _mm256_load_si256((const __m256i*)(weights + i))));
+        clipped = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256((const __m256i*)(them + i)), zero), ceiling);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(clipped, _mm256_load_si256((const __m256i*)(weights + NNUE_HIDDEN + i))));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+int simdSupported(){
+#ifdef NNUE_X86
+    if(__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+    if(__builtin_cpu_supports("sse2"))
+        return SIMD_SSE2;
+#endif
+    return SIMD_SCALAR;
+}
+
+static int level = -1;
+static UpdateKernel updateKernel = updateScalar;
+static OutputKernel outputKernel = outputScalar;
+
+void setSimdLevel(int wanted){
+    level = std::min(wanted, simdSupported());
+    updateKernel = updateScalar;
+    outputKernel = outputScalar;
+#ifdef NNUE_X86
+    if(level == SIMD_SSE2){
+        updateKernel = updateSse2;
+        outputKernel = outputSse2;
+    }
+    else if(level == SIMD_AVX2){
+        updateKernel = updateAvx2;
+        outputKernel = outputAvx2;
+    }
+#endif
+}
+
+int simdLevel(){
+    if(level < 0)
+        setSimdLevel(simdSupported());
+    return level;
+}
+
+std::string simdName(int simd){
+    return simd == SIMD_AVX2? "avx2" : simd == SIMD_SSE2? "sse2" : "scalar";
+}
+
+bool loadNetwork(const std::string& path){
+    std::ifstream file(path, std::ios::binary);
+    char magic[8];
+    std::unique_ptr<Network> loaded(new Network);
+    if(!file.read(magic, sizeof(magic)) || memcmp(magic, NETWORK_MAGIC, sizeof(magic)) != 0)
+        return false;
+    if(!file.read((char*)loaded.get(), sizeof(Network)) || file.peek() != EOF)
+        return false;
+    network = std::move(loaded);
+    simdLevel();
+    return true;
+}
+
+void randomNetwork(uint64_t seed){
+    std::mt19937_64 random(seed);
+    std::unique_ptr<Network> made(new Network);
+    auto weight = [&](int range) {return int16_t(int(random() % (2 * range + 1)) - range);};
+    for(int input = 0; input < NNUE_INPUTS; input++){
+        for(int i = 0; i < NNUE_HIDDEN; i++)
+            made->inputWeights[input][i] = weight(32);
+    }
+    for(int i = 0; i < NNUE_HIDDEN; i++){
+        made->inputBias[i] = weight(64) + 64;
+        made->outputWeights[0][i] = weight(64);
+        made->outputWeights[1][i] = weight(64);
+    }
+    made->outputBias = 0;
+    network = std::move(made);
+    simdLevel();
+}
+
+void unloadNetwork(){
+    network.reset();
+}
+
+bool networkLoaded(){
+    return network != nullptr;
+}
+
+int featureIndex(int perspective, Piece piece, int position){
+    //Each side sees its own pieces first and the board from its own end, so both halves share one set of weights
+    int side = (pieceColor(piece) == perspective? 0 : 1);
+    return (side * 6 + pieceType(piece)) * 64 + (perspective == WHITE? position : position ^ 56);
+}
+
+void refreshAccumulator(ChessBoard* chessBoard, Accumulator& accumulator){
+    for(int perspective: {BLACK, WHITE}){
+        const int16_t* rows[32];
+        int count = 0;
+        Bitboard occupied = chessBoard->getOccupancy();
+        while(occupied && count < 32){
+            int position = popLsb(occupied);
+            rows[count++] = network->inputWeights[featureIndex(perspective, chessBoard->getBoard()[position], position)];
+        }
+        updateKernel(network->inputBias, accumulator.values[colorIndex(perspective)], rows, count, nullptr, 0);
+    }
+}
+
+//Clear of the mate scores whatever the weights
+static const int NETWORK_MAX_SCORE = 20000;
+
+int networkEvaluate(ChessBoard* chessBoard, const Accumulator& accumulator){
+    int us = colorIndex(chessBoard->getTurn());
+    int64_t sum = outputKernel(accumulator.values[us], accumulator.values[1 - us], network->outputWeights[0]) + int64_t(network->outputBias);
+    int64_t score = sum * NNUE_SCALE / (NNUE_QA * NNUE_QB);
+    return int(std::min(std::max(score, int64_t(-NETWORK_MAX_SCORE)), int64_t(NETWORK_MAX_SCORE)));
+}
+
+void AccumulatorStack::reset(ChessBoard* chessBoard){
+    if(entries.empty())
+        entries.resize(MAX_STACK);
+    top = 0;
+    refreshAccumulator(chessBoard, entries[0].accumulator);
+    entries[0].computed = true;
+}
+
+void AccumulatorStack::push(Move move, Piece moving, Piece captured, int captureAt){
+    if(++top == entries.size())
+        entries.emplace_back();
+    Entry& entry = entries[top];
+    int source = moveFrom(move), destination = moveTo(move);
+    entry.computed = false;
+    entry.removed[0] = moving;
+    entry.removedAt[0] = source;
+    entry.removedCount = 1;
+    entry.added[0] = (isPromotion(move)? makePiece(pieceColor(moving), promotionType(move)) : moving);
+    entry.addedAt[0] = destination;
+    entry.addedCount = 1;
+    if(captured != NO_PIECE){
+        entry.removed[1] = captured;
+        entry.removedAt[1] = captureAt;
+        entry.removedCount = 2;
+    }
+    else if(moveFlag(move) == MOVE_CASTLING){
+        Piece rook = makePiece(pieceColor(moving), ROOK);
+        entry.removed[1] = entry.added[1] = rook;
+        entry.removedAt[1] = (destination > source? source + 3 : source - 4);
+        entry.addedAt[1] = (source + destination) / 2;
+        entry.removedCount = entry.addedCount = 2;
+    }
+}
+
+void AccumulatorStack::update(const Entry& from, Entry& to){
+    for(int perspective: {BLACK, WHITE}){
+        const int16_t* added[2];
+        const int16_t* removed[2];
+        for(int i = 0; i < to.addedCount; i++)
+            added[i] = network->inputWeights[featureIndex(perspective, to.added[i], to.addedAt[i])];
+        for(int i = 0; i < to.removedCount; i++)
+            removed[i] = network->inputWeights[featureIndex(perspective, to.removed[i], to.removedAt[i])];
+        updateKernel(from.accumulator.values[colorIndex(perspective)], to.accumulator.values[colorIndex(perspective)], added, to.addedCount, removed, to.removedCount);
+    }
+    to.computed = true;
+}
+
+const Accumulator& AccumulatorStack::current(){
+    size_t last = top;
+    while(!entries[last].computed)
+        last--;
+    for(size_t i = last + 1; i <= top; i++)
+        update(entries[i - 1], entries[i]);
+    return entries[top].accumulator;
+}
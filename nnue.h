@@ -0,0 +1,86 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "chess.h"
+
+//An efficiently updatable network: one input for every piece on every square, seen from each side, feeds a hidden
+//layer of NNUE_HIDDEN neurons per side, and the two halves, side to move first, feed one output. The hidden layer
+//(the accumulator) only changes by a few rows of the input weights per move, so it follows the search move by move.
+//
+//A network file is NETWORK_MAGIC followed by a Network in native byte order. The hidden layer is clipped to
+//[0, NNUE_QA] and the output is worked out at NNUE_QA * NNUE_QB times its scale, which is NNUE_SCALE centipawns.
+const char NETWORK_MAGIC[8] = {'C', 'H', 'S', 'N', 'N', 'U', 'E', '1'};
+const int NNUE_INPUTS = 768;
+const int NNUE_HIDDEN = 256;
+const int NNUE_QA = 255;
+const int NNUE_QB = 64;
+const int NNUE_SCALE = 400;
+
+struct Network{
+    alignas(32) int16_t inputWeights[NNUE_INPUTS][NNUE_HIDDEN];
+    alignas(32) int16_t inputBias[NNUE_HIDDEN];
+    alignas(32) int16_t outputWeights[2][NNUE_HIDDEN];
+    int32_t outputBias;
+};
+
+//Kernels for the accumulator and the output, from the plain C++ loops up to AVX2
+const int SIMD_SCALAR = 0;
+const int SIMD_SSE2 = 1;
+const int SIMD_AVX2 = 2;
+//The best kernels this processor runs
+int simdSupported();
+//The kernels in use, the best supported unless setSimdLevel chose others
+int simdLevel();
+//Not thread safe, for benchmarks. Levels above the supported one are lowered to it.
+void setSimdLevel(int level);
+std::string simdName(int level);
+
+//Returns false if the file cannot be read or is not a network. The network must be loaded before any search starts.
+bool loadNetwork(const std::string& path);
+//Fills the network with small random weights, which play badly but cost the same to run as trained ones
+void randomNetwork(uint64_t seed);
+void unloadNetwork();
+bool networkLoaded();
+
+//The inputs a piece on a square switches on, seen from each side
+int featureIndex(int perspective, Piece piece, int position);
+
+struct Accumulator{
+    alignas(32) int16_t values[2][NNUE_HIDDEN]; //Indexed by colorIndex of the side seeing the board
+};
+
+//Works the accumulator out from scratch
+void refreshAccumulator(ChessBoard* chessBoard, Accumulator& accumulator);
+//The network's evaluation of the board in centipawns from the point of view of the side to move
+int networkEvaluate(ChessBoard* chessBoard, const Accumulator& accumulator);
+
+//One accumulator for every move a search has on its board. makeMove only notes which pieces left and reached
+//which squares; the accumulator is brought up to date from the last one computed when an evaluation asks for it,
+//so positions that are never evaluated cost nothing, and unmakeMove just steps back.
+class AccumulatorStack{
+private:
+    struct Entry{
+        Accumulator accumulator;
+        bool computed;
+        int removedCount, addedCount;
+        Piece removed[2], added[2];
+        int removedAt[2], addedAt[2];
+    };
+    std::vector<Entry> entries;
+    size_t top = 0;
+    void update(const Entry& from, Entry& to);
+public:
+    static const int MAX_STACK = 160;
+    //Starts over from the board's position, the entries are only allocated by the first reset
+    void reset(ChessBoard* chessBoard);
+    //Called by makeMove after the move is played
+    void push(Move move, Piece moving, Piece captured, int captureAt);
+    //Called by unmakeMove
+    void pop() {top--;}
+    const Accumulator& current();
+};
+
+#endif
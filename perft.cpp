@@ -0,0 +1,118 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include "perft.h"
+#include "movegen.h"
+#include "fen.h"
+
+struct PerftPosition{
+    const char* name;
+    const char* fen;
+    uint64_t expected[6]; //Node counts for depths 1 to 6, 0 where the count is not recorded
+};
+
+//The standard reference positions, covering castling, en passant, promotions and discovered checks
+static const PerftPosition referencePositions[] = {
+    {"start", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", {20, 400, 8902, 197281, 4865609, 119060324}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", {48, 2039, 97862, 4085603, 193690690, 0}},
+    {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", {14, 191, 2812, 43238, 674624, 11030083}},
+    {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", {6, 264, 9467, 422333, 15833292, 0}},
+    {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", {44, 1486, 62379, 2103487, 89941194, 0}},
+    {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", {46, 2079, 89890, 3894594, 164075551, 0}},
+};
+
+//Checks that can only be answered by interposing, on the first two or last two ranks among others, where the
+//shortcut hasLegalMove takes must agree with the full generator
+static const char* blockedChecks[] = {
+    "6k1/8/8/8/8/8/6PP/r6K w - - 0 1",
+    "6k1/8/8/8/8/4N3/6PP/r6K w - - 0 1",
+    "6k1/8/8/8/8/6PP/r6K/6RR w - - 0 1",
+    "R6k/6pp/8/8/8/8/8/6K1 b - - 0 1",
+    "6rr/R6k/6pp/8/8/8/8/6K1 b - - 0 1",
+    "7k/8/8/PP6/K2r4/Pp6/2Pn4/8 w - - 0 1",
+    "7k/8/8/PP6/K2r4/Ppp5/2Pn4/8 w - - 0 1",
+};
+
+uint64_t perft(ChessBoard* chessBoard, int depth){
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    if(depth <= 1)
+        return depth == 1? list.size() : 1;
+    uint64_t nodes = 0;
+    UndoRecord undo;
+    for(Move move: list){
+        chessBoard->makeMove(move, undo);
+        nodes += perft(chessBoard, depth - 1);
+        chessBoard->unmakeMove(undo);
+    }
+    return nodes;
+}
+
+//Prints the node count below every root move, the usual way to narrow down a move generation bug
+static int divide(const std::string& fen, int depth){
+    ChessBoard chessBoard;
+    if(!setupPosition(&chessBoard, fen)){
+        std::cout<<"Invalid FEN: "<<fen<<"\n";
+        return 1;
+    }
+    MoveList list;
+    generateLegalMoves(&chessBoard, list);
+    uint64_t total = 0;
+    UndoRecord undo;
+    for(Move move: list){
+        chessBoard.makeMove(move, undo);
+        uint64_t nodes = perft(&chessBoard, depth - 1);
+        chessBoard.unmakeMove(undo);
+        std::cout<<moveToString(move)<<": "<<nodes<<"\n";
+        total += nodes;
+    }
+    std::cout<<"\nNodes: "<<total<<"\n";
+    return 0;
+}
+
+int perftCommand(int argc, char* argv[]){
+    int depth = (argc > 2? atoi(argv[2]) : 4);
+    if(depth < 1){
+        std::cout<<"Usage: chess perft [depth] [fen]\n";
+        return 1;
+    }
+    if(argc > 3){
+        std::string fen = argv[3];
+        for(int i = 4; i < argc; i++)
+            fen += std::string(" ") + argv[i];
+        return divide(fen, depth);
+    }
+
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for(const PerftPosition& reference: referencePositions){
+        ChessBoard chessBoard;
+        setupPosition(&chessBoard, reference.fen);
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft(&chessBoard, depth);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        totalNodes += nodes;
+        totalSeconds += seconds;
+
+        uint64_t expected = (depth <= 6? reference.expected[depth - 1] : 0);
+        std::cout<<reference.name<<"\tdepth "<<depth<<"\tnodes "<<nodes<<"\t"<<uint64_t(nodes / (seconds > 0? seconds : 1e-9))<<" nps";
+        if(expected != 0){
+            std::cout<<(nodes == expected? "\tok" : "\tFAILED, expected ")<<(nodes == expected? "" : std::to_string(expected));
+            allPassed = allPassed && nodes == expected;
+        }
+        std::cout<<"\n";
+    }
+    for(const char* fen: blockedChecks){
+        ChessBoard chessBoard;
+        setupPosition(&chessBoard, fen);
+        MoveList list;
+        generateLegalMoves(&chessBoard, list);
+        if(hasLegalMove(&chessBoard) != (list.size() > 0)){
+            std::cout<<"hasLegalMove FAILED on "<<fen<<"\n";
+            allPassed = false;
+        }
+    }
+    std::cout<<"Total\tnodes "<<totalNodes<<"\t"<<totalSeconds<<" s\t"<<uint64_t(totalNodes / (totalSeconds > 0? totalSeconds : 1e-9))<<" nps\n";
+    return allPassed? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include "chess.h"
+
+//Counts the leaf nodes of the legal move tree below the position, to the given depth
+uint64_t perft(ChessBoard* chessBoard, int depth);
+//Entry point for "chess perft [depth] [fen]", runs the reference positions or divides a single one
+int perftCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,288 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pgn.h"
+#include "fen.h"
+#include "movegen.h"
+
+//Games are handed out in batches of this many per thread. The pages of a finished batch are given back to the
+//system, so memory use depends on the batch size and not on the size of the file.
+const size_t GAMES_PER_THREAD = 1024;
+
+Move parseSan(ChessBoard* chessBoard, std::string_view san, std::string* error){
+    //Check, mate and annotation marks say nothing about which move it is
+    while(!san.empty() && strchr("+#!?", san.back()))
+        san.remove_suffix(1);
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+
+    if(san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0"){
+        bool queenside = (san.size() == 5);
+        for(Move move: list){
+            if(moveFlag(move) == MOVE_CASTLING && (moveTo(move) < moveFrom(move)) == queenside)
+                return move;
+        }
+        if(error != nullptr)
+            *error = "castling is not legal here";
+        return NO_MOVE;
+    }
+
+    int type = PAWN, promotion = -1;
+    if(!san.empty() && strchr("NBRQK", san.front())){
+        type = int(strchr("PNBRQK", san.front()) - "PNBRQK");
+        san.remove_prefix(1);
+    }
+    if(type == PAWN && !san.empty() && strchr("NBRQ", san.back())){
+        promotion = int(strchr("PNBRQK", san.back()) - "PNBRQK");
+        san.remove_suffix(1);
+        if(!san.empty() && san.back() == '=')
+            san.remove_suffix(1);
+    }
+    if(san.size() < 2 || san[san.size() - 2] < 'a' || san[san.size() - 2] > 'h' || san.back() < '1' || san.back() > '8'){
+        if(error != nullptr)
+            *error = "not a move";
+        return NO_MOVE;
+    }
+    int destination = san[san.size() - 2] - 'a' + (san.back() - '1') * 8;
+    san.remove_suffix(2);
+    if(!san.empty() && san.back() == 'x')
+        san.remove_suffix(1);
+    //What is left tells apart two pieces that could both reach the destination
+    int fromFile = -1, fromRank = -1;
+    for(char c: san){
+        if('a' <= c && c <= 'h')
+            fromFile = c - 'a';
+        else if('1' <= c && c <= '8')
+            fromRank = c - '1';
+        else{
+            if(error != nullptr)
+                *error = "not a move";
+            return NO_MOVE;
+        }
+    }
+
+    Move found = NO_MOVE;
+    int matches = 0;
+    Piece* board = chessBoard->getBoard();
+    for(Move move: list){
+        int source = moveFrom(move);
+        if(moveTo(move) != destination || pieceType(board[source]) != type || moveFlag(move) == MOVE_CASTLING)
+            continue;
+        if((fromFile >= 0 && source % 8 != fromFile) || (fromRank >= 0 && source / 8 != fromRank))
+            continue;
+        if(isPromotion(move)? promotionType(move) != promotion : promotion != -1)
+            continue;
+        found = move;
+        matches++;
+    }
+    if(matches == 1)
+        return found;
+    if(error != nullptr)
+        *error = (matches == 0? "illegal move" : "ambiguous move");
+    return NO_MOVE;
+}
+
+//The value of a tag such as [FEN "..."], or an empty view if the game has none
+static std::string_view tagValue(std::string_view game, std::string_view tag){
+    for(size_t at = game.find('['); at != std::string_view::npos; at = game.find('[', at + 1)){
+        if(game.compare(at + 1, tag.size(), tag) != 0 || at + 1 + tag.size() >= game.size() || game[at + 1 + tag.size()] != ' ')
+            continue;
+        size_t open = game.find('"', at), close = game.find('"', open + 1);
+        if(open == std::string_view::npos || close == std::string_view::npos)
+            return std::string_view();
+        return game.substr(open + 1, close - open - 1);
+    }
+    return std::string_view();
+}
+
+//Finds the end of a bracketed block, counting nesting for variations
+static size_t skipBlock(std::string_view game, size_t at, char open, char close){
+    int depth = 0;
+    for(; at < game.size(); at++){
+        if(game[at] == open)
+            depth++;
+        else if(game[at] == close && --depth == 0)
+            return at + 1;
+    }
+    return at;
+}
+
+GameResult replayGame(std::string_view game, const std::function<void(ChessBoard*, Move)>& onMove){
+    GameResult result;
+    ChessBoard chessBoard;
+    std::string_view fen = tagValue(game, "FEN");
+    if(fen.empty())
+        newGame(&chessBoard);
+    else if(!setupPosition(&chessBoard, std::string(fen))){
+        result.error = "invalid FEN tag";
+        return result;
+    }
+
+    UndoRecord undo;
+    size_t at = 0;
+    while(at < game.size()){
+        char c = game[at];
+        if(c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '.'){
+            at++;
+            continue;
+        }
+        if(c == '[')
+            at = skipBlock(game, at, '[', ']');
+        else if(c == '{')
+            at = skipBlock(game, at, '{', '}');
+        else if(c == '(')
+            at = skipBlock(game, at, '(', ')');
+        else if(c == ';' || (c == '%' && (at == 0 || game[at - 1] == '\n'))){
+            at = game.find('\n', at);
+        }
+        else{
+            size_t end = game.find_first_of(" \t\r\n{}();[", at);
+            if(end == std::string_view::npos)
+                end = game.size();
+            std::string_view token = game.substr(at, end - at);
+            at = end;
+            //Move numbers such as 12. and 12... may be written up against the move
+            size_t digits = token.find_first_not_of("0123456789");
+            if(digits == std::string_view::npos || token[0] == '$')
+                continue;
+            if(digits > 0 && token[digits] == '.'){
+                size_t move = token.find_first_not_of('.', digits);
+                if(move == std::string_view::npos)
+                    continue;
+                token = token.substr(move);
+            }
+            if(token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*"){
+                result.outcome = std::string(token);
+                break;
+            }
+            std::string reason;
+            Move move = parseSan(&chessBoard, token, &reason);
+            if(move == NO_MOVE){
+                int number = chessBoard.getFullmoveNumber();
+                result.error = "move " + std::to_string(number) + (chessBoard.getTurn() == WHITE? ". " : "... ") + std::string(token) + ": " + reason;
+                return result;
+            }
+            if(onMove)
+                onMove(&chessBoard, move);
+            chessBoard.makeMove(move, undo);
+            result.plies++;
+        }
+        if(at == std::string_view::npos)
+            break;
+    }
+    if(result.outcome.empty())
+        result.outcome = std::string(tagValue(game, "Result"));
+    return result;
+}
+
+//A game runs up to the next line opening a tag section after movetext
+std::string_view nextPgnGame(std::string_view text, size_t& offset){
+    size_t start = offset;
+    bool movetext = false;
+    while(offset < text.size()){
+        size_t lineEnd = text.find('\n', offset);
+        lineEnd = (lineEnd == std::string_view::npos? text.size() : lineEnd + 1);
+        size_t first = text.find_first_not_of(" \t\r\n", offset);
+        if(first < lineEnd){
+            if(text[first] == '['){
+                if(movetext)
+                    break;
+            }
+            else
+                movetext = true;
+        }
+        offset = lineEnd;
+    }
+    return text.substr(start, offset - start);
+}
+
+int pgnCommand(int argc, char* argv[]){
+    if(argc < 3){
+        std::cout<<"Usage: chess pgn <file> [threads]\n";
+        return 1;
+    }
+    int threads = (argc > 3? atoi(argv[3]) : int(std::thread::hardware_concurrency()));
+    if(threads < 1)
+        threads = 1;
+
+    int fd = open(argv[2], O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0){
+        std::cout<<"Cannot open "<<argv[2]<<"\n";
+        return 1;
+    }
+    size_t size = info.st_size;
+    const char* data = nullptr;
+    if(size > 0){
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            std::cout<<"Cannot map "<<argv[2]<<"\n";
+            close(fd);
+            return 1;
+        }
+        data = (const char*)mapping;
+        madvise(mapping, size, MADV_SEQUENTIAL);
+    }
+    std::string_view text(data, size);
+    size_t pageSize = sysconf(_SC_PAGESIZE), released = 0;
+
+    std::vector<std::string_view> games;
+    std::vector<GameResult> results;
+    uint64_t gameCount = 0, plies = 0, failed = 0;
+    size_t offset = 0;
+    auto start = std::chrono::steady_clock::now();
+    while(offset < text.size()){
+        games.clear();
+        while(games.size() < GAMES_PER_THREAD * threads && offset < text.size()){
+            std::string_view game = nextPgnGame(text, offset);
+            if(game.find_first_not_of(" \t\r\n") != std::string_view::npos)
+                games.push_back(game);
+        }
+        results.assign(games.size(), GameResult());
+
+        std::atomic<size_t> next{0};
+        auto work = [&]{
+            for(size_t i = next++; i < games.size(); i = next++)
+                results[i] = replayGame(games[i]);
+        };
+        std::vector<std::thread> workers;
+        for(int i = 1; i < threads; i++)
+            workers.emplace_back(work);
+        work();
+        for(std::thread& worker: workers)
+            worker.join();
+
+        for(size_t i = 0; i < results.size(); i++){
+            plies += results[i].plies;
+            if(!results[i].error.empty()){
+                failed++;
+                std::cout<<"Game "<<gameCount + i + 1<<": "<<results[i].error<<"\n";
+            }
+        }
+        gameCount += games.size();
+        //Everything before the next game has been read for good
+        size_t done = offset / pageSize * pageSize;
+        if(done > released){
+            madvise((void*)(data + released), done - released, MADV_DONTNEED);
+            released = done;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(seconds <= 0)
+        seconds = 1e-9;
+    std::cout<<gameCount<<" games, "<<failed<<" with errors, "<<plies<<" plies in "<<seconds<<" s\n"
+    <<uint64_t(gameCount / seconds)<<" games/s, "<<uint64_t(plies / seconds)<<" plies/s\n";
+    if(data != nullptr)
+        munmap((void*)data, size);
+    close(fd);
+    return failed == 0? 0 : 1;
+}
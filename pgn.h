@@ -0,0 +1,28 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include "chess.h"
+
+//Finds the legal move of the side to move that a SAN move such as Nbd7, exd6, e8=Q or O-O stands for.
+//Returns NO_MOVE, with the reason in error when given, if no legal move or more than one matches.
+Move parseSan(ChessBoard* chessBoard, std::string_view san, std::string* error = nullptr);
+
+struct GameResult{
+    int plies = 0;
+    std::string error; //Empty when every move was legal
+    std::string outcome; //1-0, 0-1, 1/2-1/2 or * as written at the end of the movetext or in the Result tag
+};
+
+//Replays the movetext of one PGN game from its FEN tag or the starting position, stopping at the first bad move.
+//onMove, when given, sees each move with the board still in the position it is played from.
+GameResult replayGame(std::string_view game, const std::function<void(ChessBoard*, Move)>& onMove = nullptr);
+//Splits off the game starting at offset, its tag section and movetext, and moves offset on to the next game
+std::string_view nextPgnGame(std::string_view text, size_t& offset);
+
+//Entry point for "chess pgn <file> [threads]"
+int pgnCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,55 @@
+#include "ponder.h"
+#include "movegen.h"
+
+bool Ponderer::start(ChessBoard* chessBoard, const std::vector<uint64_t>& gameKeys, TranspositionTable& tt, int threads, const SearchLimits& searchLimits){
+    cancel();
+    TTData entry;
+    if(!tt.probe(chessBoard->getKey(), entry) || entry.move == NO_MOVE)
+        return false;
+    //The entry may belong to another position with the same bucket and key, so only a legal move is trusted
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    predicted = NO_MOVE;
+    for(Move move: list){
+        if(move == entry.move)
+            predicted = move;
+    }
+    if(predicted == NO_MOVE)
+        return false;
+
+    board = *chessBoard;
+    UndoRecord undo;
+    board.makeMove(predicted, undo);
+    keys = gameKeys;
+    keys.push_back(board.getKey());
+    limits = searchLimits;
+    best = NO_MOVE;
+    last = SearchReport();
+    search.reset(new ParallelSearch(&board, tt, keys, threads));
+    search->onIteration = [this](const SearchReport& report){last = report;};
+    search->ponder();
+    thread = std::thread([this]{best = search->run(limits);});
+    return true;
+}
+
+Move Ponderer::finish(Move played, SearchReport& report){
+    if(!thread.joinable())
+        return NO_MOVE;
+    bool hit = (played == predicted);
+    if(hit)
+        search->ponderHit();
+    else
+        search->requestStop();
+    thread.join();
+    search.reset();
+    report = last;
+    return hit? best : NO_MOVE;
+}
+
+void Ponderer::cancel(){
+    if(!thread.joinable())
+        return;
+    search->requestStop();
+    thread.join();
+    search.reset();
+}
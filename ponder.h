@@ -0,0 +1,41 @@
+#ifndef PONDER_H
+#define PONDER_H
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include "smp.h"
+
+//Searches on a background thread while the opponent thinks. The reply they are expected to make is the best
+//move the hash table holds for their position, and the search is of the position after it. If they play it
+//the search goes on keeping time from when it started, so after a long think the answer comes at once;
+//otherwise it is cancelled and has only left the hash table warmer for the search that follows.
+class Ponderer{
+private:
+    ChessBoard board;
+    std::vector<uint64_t> keys;
+    SearchLimits limits;
+    Move predicted = NO_MOVE;
+    std::unique_ptr<ParallelSearch> search;
+    std::thread thread;
+    //Written by the pondering thread, read once it has been joined
+    Move best = NO_MOVE;
+    SearchReport last;
+public:
+    Ponderer() = default;
+    Ponderer(const Ponderer&) = delete;
+    Ponderer& operator=(const Ponderer&) = delete;
+    ~Ponderer() {cancel();}
+    //Starts pondering the opponent's position, with the game's keys up to it. Returns false when the hash table
+    //has no legal move to predict.
+    bool start(ChessBoard* chessBoard, const std::vector<uint64_t>& gameKeys, TranspositionTable& tt, int threads, const SearchLimits& searchLimits);
+    bool isPondering() const {return thread.joinable();}
+    Move getPredicted() const {return predicted;}
+    //Called with the move the opponent played. On a hit waits for the search and returns its move, with the
+    //report of its last iteration; on a miss cancels it and returns NO_MOVE.
+    Move finish(Move played, SearchReport& report);
+    //Stops the search, if there is one, and waits for its thread
+    void cancel();
+};
+
+#endif
@@ -0,0 +1,329 @@
+#include <cstdlib>
+#include <utility>
+#include "search.h"
+#include "movegen.h"
+#include "eval.h"
+#include "zobrist.h"
+#include "tablebase.h"
+
+//Mate scores are stored relative to the node rather than the root, so they stay right when found again elsewhere
+static int scoreToTT(int score, int ply){
+    if(score >= MATE_BOUND)
+        return score + ply;
+    if(score <= -MATE_BOUND)
+        return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply){
+    if(score >= MATE_BOUND)
+        return score - ply;
+    if(score <= -MATE_BOUND)
+        return score + ply;
+    return score;
+}
+
+//Further from mate than the search can see, a table win still scores above any evaluation
+static int tablebaseScore(const TablebaseResult& result, int ply){
+    int score = MATE_SCORE - ply - result.plies;
+    return result.outcome == 0? 0 : result.outcome > 0? score : -score;
+}
+
+Search::Search(ChessBoard* chessBoard, TranspositionTable& tt, const std::vector<uint64_t>& gameKeys, CancellationToken* sharedToken):
+chessBoard(chessBoard), tt(tt), token(sharedToken != nullptr? sharedToken : &ownToken), keys(gameKeys){
+    for(int i = 0; i < 2; i++){
+        for(int from = 0; from < 64; from++){
+            for(int to = 0; to < 64; to++)
+                history[i][from][to] = 0;
+        }
+    }
+}
+
+int64_t Search::elapsed(){
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Looking at the clock is slow compared to a node, so it only happens every 2048 nodes
+void Search::checkTime(){
+    if(token->isCancelled())
+        stopped = true;
+    else if(limits.nodes > 0 && getNodes() >= limits.nodes)
+        stopped = true;
+    else if(keepsTime && (getNodes() & 2047) == 0 && limits.moveTime > 0 && !token->isPondering() && elapsed() >= limits.moveTime){
+        stopped = true;
+        token->cancel();
+    }
+}
+
+//The hash move goes first, then captures that do not lose material by most valuable victim and least valuable attacker,
+//then killers and history, and captures that lose material last
+void Search::scoreMoves(MoveList& list, int scores[], Move ttMove, int ply){
+    Piece* board = chessBoard->getBoard();
+    int side = colorIndex(chessBoard->getTurn());
+    for(int i = 0; i < list.size(); i++){
+        Move move = list.moves[i];
+        int source = moveFrom(move), destination = moveTo(move);
+        Piece victim = board[destination];
+        if(move == ttMove)
+            scores[i] = 1 << 30;
+        else if(victim != NO_PIECE || moveFlag(move) == MOVE_EN_PASSANT || isPromotion(move)){
+            int gain = (victim != NO_PIECE? pieceValues[pieceType(victim)] : moveFlag(move) == MOVE_EN_PASSANT? pieceValues[PAWN] : 0);
+            if(isPromotion(move))
+                gain += pieceValues[promotionType(move)];
+            //Taking a piece worth at least the one taking cannot lose material, so only the others need the exchange worked out
+            bool winning = ((!isPromotion(move) && gain >= pieceValues[pieceType(board[source])]) || chessBoard->staticExchange(move) >= 0);
+            scores[i] = (winning? 1 << 28 : -(1 << 28)) + gain * 8 - pieceType(board[source]);
+        }
+        else if(move == killers[ply][0])
+            scores[i] = (1 << 27) + 1;
+        else if(move == killers[ply][1])
+            scores[i] = 1 << 27;
+        else
+            scores[i] = history[side][source][destination];
+    }
+}
+
+//Swaps the best scored move still to be searched into position i
+static Move pickMove(MoveList& list, int scores[], int i){
+    int best = i;
+    for(int j = i + 1; j < list.size(); j++){
+        if(scores[j] > scores[best])
+            best = j;
+    }
+    std::swap(list.moves[i], list.moves[best]);
+    std::swap(scores[i], scores[best]);
+    return list.moves[i];
+}
+
+int Search::quiescence(int alpha, int beta, int ply){
+    countNode();
+    checkTime();
+    if(stopped)
+        return 0;
+    if(ply >= MAX_PLY - 1)
+        return evaluate(chessBoard);
+
+    //Out of check the side to move may stand pat instead of capturing, in check every evasion is searched
+    bool check = chessBoard->inCheck();
+    int best = -INFINITE_SCORE;
+    if(!check){
+        best = evaluate(chessBoard);
+        if(best >= beta)
+            return best;
+        if(best > alpha)
+            alpha = best;
+    }
+
+    MoveList list;
+    generateLegalMoves(chessBoard, list, !check);
+    if(check && list.size() == 0)
+        return -MATE_SCORE + ply;
+    int scores[256];
+    scoreMoves(list, scores, NO_MOVE, ply);
+
+    UndoRecord undo;
+    for(int i = 0; i < list.size(); i++){
+        Move move = pickMove(list, scores, i);
+        //Out of check the captures left all lose material and are not worth searching
+        if(!check && scores[i] < 0)
+            break;
+        chessBoard->makeMove(move, undo);
+        int score = -quiescence(-beta, -alpha, ply + 1);
+        chessBoard->unmakeMove(undo);
+        if(stopped)
+            return 0;
+        if(score > best){
+            best = score;
+            if(score > alpha){
+                alpha = score;
+                if(score >= beta)
+                    break;
+            }
+        }
+    }
+    return best;
+}
+
+int Search::alphaBeta(int alpha, int beta, int depth, int ply){
+    pvLength[ply] = ply;
+    bool check = chessBoard->inCheck();
+    if(check && ply < MAX_PLY / 2)
+        depth++;
+    if(depth <= 0)
+        return quiescence(alpha, beta, ply);
+
+    countNode();
+    checkTime();
+    if(stopped)
+        return 0;
+
+    bool root = (ply == 0);
+    bool pvNode = (beta - alpha > 1);
+    if(!root){
+        //Fifty moves without a capture or pawn move, or a position already seen on this path or in the game
+        if(chessBoard->getHalfmoveClock() >= 100 || countRepetitions(keys, chessBoard->getHalfmoveClock()) >= 1)
+            return 0;
+        if(ply >= MAX_PLY - 1)
+            return evaluate(chessBoard);
+        //With few enough pieces left the endgame tables know the exact result
+        TablebaseResult known;
+        if(popCount(chessBoard->getOccupancy()) <= tablebasePieces() && chessBoard->probeTablebase(known))
+            return tablebaseScore(known, ply);
+    }
+
+    uint64_t key = chessBoard->getKey();
+    TTData entry;
+    Move ttMove = NO_MOVE;
+    if(tt.probe(key, entry)){
+        ttMove = entry.move;
+        int score = scoreFromTT(entry.score, ply);
+        if(!pvNode && entry.depth >= depth){
+            if(entry.bound == BOUND_EXACT || (entry.bound == BOUND_LOWER && score >= beta) || (entry.bound == BOUND_UPPER && score <= alpha))
+                return score;
+        }
+    }
+
+    //Well ahead of beta close to the horizon, the opponent is not going to get back into the game
+    int staticEval = 0;
+    if(!check){
+        staticEval = evaluate(chessBoard);
+        if(!pvNode && depth <= 3 && staticEval - 120 * depth >= beta && abs(beta) < MATE_BOUND)
+            return staticEval;
+    }
+
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    if(list.size() == 0)
+        return check? -MATE_SCORE + ply : 0;
+    int scores[256];
+    scoreMoves(list, scores, ttMove, ply);
+
+    int side = colorIndex(chessBoard->getTurn());
+    int best = -INFINITE_SCORE, bound = BOUND_UPPER;
+    Move bestMove = NO_MOVE;
+    UndoRecord undo;
+    for(int i = 0; i < list.size(); i++){
+        Move move = pickMove(list, scores, i);
+        bool quiet = chessBoard->getBoard()[moveTo(move)] == NO_PIECE && moveFlag(move) != MOVE_EN_PASSANT && !isPromotion(move);
+        chessBoard->makeMove(move, undo);
+        keys.push_back(chessBoard->getKey());
+
+        //The first move is searched with the full window, the rest only have to be proven worse with a null window.
+        //Late quiet moves get one ply less unless they turn out to be better after all.
+        int score;
+        if(i == 0)
+            score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1);
+        else{
+            int reduction = (depth >= 3 && i >= 4 && quiet && !check? 1 : 0);
+            score = -alphaBeta(-alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
+            if(score > alpha && (reduction > 0 || score < beta))
+                score = -alphaBeta(-beta, -alpha, depth - 1, ply + 1);
+        }
+
+        keys.pop_back();
+        chessBoard->unmakeMove(undo);
+        if(stopped)
+            return 0;
+
+        if(score > best){
+            best = score;
+            bestMove = move;
+            if(score > alpha){
+                alpha = score;
+                bound = BOUND_EXACT;
+                pv[ply][ply] = move;
+                for(int j = ply + 1; j < pvLength[ply + 1]; j++)
+                    pv[ply][j] = pv[ply + 1][j];
+                pvLength[ply] = pvLength[ply + 1];
+                if(score >= beta){
+                    bound = BOUND_LOWER;
+                    if(quiet){
+                        if(killers[ply][0] != move){
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = move;
+                        }
+                        history[side][moveFrom(move)][moveTo(move)] += depth * depth;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    tt.store(key, bestMove, scoreToTT(best, ply), staticEval, depth, bound);
+    return best;
+}
+
+Move Search::run(const SearchLimits& searchLimits){
+    STAT_TIMER(STAT_SEARCH);
+    limits = searchLimits;
+    start = std::chrono::steady_clock::now();
+    stopped = false;
+    nodes.store(0, std::memory_order_relaxed);
+    for(int ply = 0; ply < MAX_PLY; ply++)
+        killers[ply][0] = killers[ply][1] = NO_MOVE;
+    //Old history is kept but weighed down so it steers ordering without dominating the new search
+    for(int i = 0; i < 2; i++){
+        for(int from = 0; from < 64; from++){
+            for(int to = 0; to < 64; to++)
+                history[i][from][to] /= 8;
+        }
+    }
+
+    MoveList rootMoves;
+    generateLegalMoves(chessBoard, rootMoves);
+    if(rootMoves.size() == 0)
+        return NO_MOVE;
+
+    //The endgame tables pick the quickest mate or the longest defence without searching
+    TablebaseResult known;
+    Move tableMove = (popCount(chessBoard->getOccupancy()) <= tablebasePieces()? tablebaseMove(chessBoard, known) : NO_MOVE);
+    if(tableMove != NO_MOVE){
+        if(onIteration){
+            SearchReport report = {1, tablebaseScore(known, 0), getNodes(), elapsed(), std::vector<Move>(1, tableMove)};
+            onIteration(report);
+        }
+        return tableMove;
+    }
+
+    Move best = rootMoves.moves[0];
+    if(network && networkLoaded()){
+        accumulators.reset(chessBoard);
+        chessBoard->setAccumulators(&accumulators);
+    }
+
+    for(int iteration = 1; iteration <= limits.depth; iteration++){
+        int depth = (iteration + depthOffset < limits.depth? iteration + depthOffset : limits.depth);
+        int score = alphaBeta(-INFINITE_SCORE, INFINITE_SCORE, depth, 0);
+        if(stopped)
+            break;
+        best = pv[0][0];
+        if(onIteration){
+            SearchReport report = {depth, score, getNodes(), elapsed(), std::vector<Move>(pv[0], pv[0] + pvLength[0])};
+            onIteration(report);
+        }
+        //Another iteration takes longer than all the ones before it together, so it would not finish in time
+        if(keepsTime && limits.moveTime > 0 && !token->isPondering() && elapsed() * 2 > limits.moveTime)
+            break;
+        if(abs(score) >= MATE_BOUND && MATE_SCORE - abs(score) <= depth)
+            break;
+    }
+    //The board outlives the search, so it must not keep pointing at its accumulators
+    chessBoard->setAccumulators(nullptr);
+    return best;
+}
+
+std::string formatReport(const SearchReport& report){
+    std::string text = "depth " + std::to_string(report.depth) + " score ";
+    if(abs(report.score) >= MATE_BOUND){
+        int plies = MATE_SCORE - abs(report.score);
+        text += std::string("mate ") + (report.score < 0? "-" : "") + std::to_string((plies + 1) / 2);
+    }
+    else
+        text += std::to_string(report.score);
+    uint64_t nps = report.nodes * 1000 / (report.time > 0? report.time : 1);
+    text += " nodes " + std::to_string(report.nodes) + " time " + std::to_string(report.time) + " nps " + std::to_string(nps) + " pv";
+    for(Move move: report.pv)
+        text += " " + moveToString(move);
+    return text;
+}
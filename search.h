@@ -0,0 +1,98 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "chess.h"
+#include "tt.h"
+#include "nnue.h"
+
+const int MAX_PLY = 128;
+const int INFINITE_SCORE = 32001;
+//A mate found n plies from the root scores MATE_SCORE - n
+const int MATE_SCORE = 32000;
+const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+struct SearchLimits{
+    int depth = MAX_PLY - 1;
+    int64_t moveTime = 0; //Milliseconds, 0 searches until depth is reached
+    uint64_t nodes = 0; //0 for no limit
+};
+
+//How the thread that started a search tells the threads running it to stop. Nothing is ever killed: every search
+//looks at the token every few nodes and unwinds by itself, leaving the board and the hash table whole. While the
+//token is pondering the searches ignore the clock, so that a search of the reply the opponent is expected to make
+//can run for as long as they think and then, should they play it, carry on keeping time from when it started.
+class CancellationToken{
+private:
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> pondering{false};
+public:
+    void cancel() {cancelled.store(true, std::memory_order_relaxed);}
+    bool isCancelled() const {return cancelled.load(std::memory_order_relaxed);}
+    void setPondering(bool ponder) {pondering.store(ponder, std::memory_order_relaxed);}
+    bool isPondering() const {return pondering.load(std::memory_order_relaxed);}
+};
+
+//Sent after every completed iteration
+struct SearchReport{
+    int depth;
+    int score;
+    uint64_t nodes;
+    int64_t time; //Milliseconds since the search started
+    std::vector<Move> pv;
+};
+
+//Principal variation alpha-beta search with iterative deepening and a quiescence search.
+//A Search only reads and writes its own board, so several can run at once on copies of one position.
+class Search{
+private:
+    ChessBoard* chessBoard;
+    TranspositionTable& tt;
+    SearchLimits limits;
+    std::chrono::steady_clock::time_point start;
+    //Cancelled by whichever search runs out of time first and seen by every search sharing it
+    CancellationToken ownToken;
+    CancellationToken* token;
+    bool stopped = false;
+    bool keepsTime = true;
+    int depthOffset = 0;
+    //Only this search writes the count, other threads read it for reporting
+    std::atomic<uint64_t> nodes{0};
+    //Keys of the game so far followed by the current search path, for spotting repetitions
+    std::vector<uint64_t> keys;
+    Move killers[MAX_PLY][2];
+    int history[2][64][64];
+    Move pv[MAX_PLY][MAX_PLY];
+    int pvLength[MAX_PLY];
+    //Attached to the board while run searches with a network
+    AccumulatorStack accumulators;
+    bool network = true;
+
+    int64_t elapsed();
+    void countNode() {nodes.store(nodes.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); STAT_ADD(STAT_NODES, 1);}
+    void checkTime();
+    void scoreMoves(MoveList& list, int scores[], Move ttMove, int ply);
+    int alphaBeta(int alpha, int beta, int depth, int ply);
+    int quiescence(int alpha, int beta, int ply);
+public:
+    //Called with the result of each iteration, e.g. to print progress
+    std::function<void(const SearchReport&)> onIteration;
+    Search(ChessBoard* chessBoard, TranspositionTable& tt, const std::vector<uint64_t>& gameKeys, CancellationToken* sharedToken = nullptr);
+    //A helper leaves the clock to the main search, and searches offset plies deeper on each iteration so
+    //that it fills the hash table with different parts of the tree
+    void makeHelper(int offset) {keepsTime = false; depthOffset = offset;}
+    //Evaluates with the piece-square tables even when a network is loaded
+    void usePieceSquare() {network = false;}
+    //Searches the board's side to move and returns the best move found, or NO_MOVE when there is no legal move.
+    //The caller starts a new transposition table generation beforehand.
+    Move run(const SearchLimits& searchLimits);
+    uint64_t getNodes() {return nodes.load(std::memory_order_relaxed);}
+};
+
+std::string formatReport(const SearchReport& report);
+
+#endif
@@ -0,0 +1,385 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include "server.h"
+#include "fen.h"
+#include "movegen.h"
+#include "stats.h"
+
+//Moves are kept in blocks drawn from a shared pool, so a game holds only as much history as it has played
+const int MOVES_PER_BLOCK = 30;
+
+struct MoveBlock{
+    Move moves[MOVES_PER_BLOCK];
+    int32_t next = -1;
+};
+
+struct Game{
+    ChessBoard board;
+    int32_t firstBlock = -1;
+    int32_t lastBlock = -1;
+    uint32_t plies = 0;
+    int32_t owner = -1; //The connection's socket, -1 while the slot is free
+};
+
+//Fixed-size items in one growing array, with released slots reused before the array grows again
+template<class T> class Pool{
+private:
+    std::vector<T> items;
+    std::vector<int32_t> freeSlots;
+public:
+    void reserve(size_t count) {items.reserve(count);}
+    int32_t allocate(){
+        if(freeSlots.empty()){
+            items.emplace_back();
+            return int32_t(items.size() - 1);
+        }
+        int32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        items[slot] = T();
+        return slot;
+    }
+    void release(int32_t slot) {freeSlots.push_back(slot);}
+    T& operator[](int32_t slot) {return items[slot];}
+    size_t size() {return items.size();}
+    size_t inUse() {return items.size() - freeSlots.size();}
+};
+
+//A client sending a longer line, or not reading replies past this many bytes, is disconnected rather than
+//left to fill the server's memory
+const size_t MAX_LINE = 4096;
+const size_t MAX_PENDING_OUTPUT = 1 << 20;
+
+struct Connection{
+    std::string input;
+    std::string output;
+    std::vector<int32_t> games;
+    bool ended = false; //The client has closed its end, the connection closes once the replies are sent
+};
+
+class GameServer{
+private:
+    Pool<Game> games;
+    Pool<MoveBlock> blocks;
+    std::unordered_map<int, Connection> connections;
+    size_t maxGames;
+    int epoll = -1;
+
+    Game* findGame(int fd, std::string_view id, int32_t& slot);
+    void closeGame(int32_t slot);
+    void record(Game& game, Move move);
+    std::string handle(int fd, std::string_view request);
+    void closeConnection(int fd);
+    void readFrom(int fd);
+    void writeTo(int fd);
+    bool handleLines(int fd);
+public:
+    GameServer(size_t maxGames): maxGames(maxGames) {games.reserve(maxGames);}
+    int run(const char* path);
+};
+
+//Legal moves are found by generating them all and comparing their coordinate notation
+static Move findMove(ChessBoard* chessBoard, std::string_view text){
+    STAT_ADD(STAT_LEGALITY_CHECKS, 1);
+    STAT_TIMER(STAT_MOVE_VALIDATION);
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    for(Move move: list){
+        if(moveToString(move) == text)
+            return move;
+    }
+    return NO_MOVE;
+}
+
+//The game status with spaces replaced so the reply stays one word, or check or none while the game goes on
+static std::string statusReport(ChessBoard* chessBoard){
+    int status = gameStatus(chessBoard);
+    if(status == STATUS_PLAYING)
+        return chessBoard->inCheck()? "check" : "none";
+    std::string name = statusName(status);
+    for(char& c: name){
+        if(c == ' ')
+            c = '-';
+    }
+    return name;
+}
+
+Game* GameServer::findGame(int fd, std::string_view id, int32_t& slot){
+    if(id.empty() || id.size() > 9 || id.find_first_not_of("0123456789") != std::string_view::npos)
+        return nullptr;
+    slot = std::stoi(std::string(id));
+    if(size_t(slot) >= games.size() || games[slot].owner != fd)
+        return nullptr;
+    return &games[slot];
+}
+
+void GameServer::record(Game& game, Move move){
+    int offset = game.plies % MOVES_PER_BLOCK;
+    if(offset == 0){
+        int32_t block = blocks.allocate();
+        if(game.lastBlock >= 0)
+            blocks[game.lastBlock].next = block;
+        else
+            game.firstBlock = block;
+        game.lastBlock = block;
+    }
+    blocks[game.lastBlock].moves[offset] = move;
+    game.plies++;
+}
+
+void GameServer::closeGame(int32_t slot){
+    for(int32_t block = games[slot].firstBlock; block >= 0; block = blocks[block].next)
+        blocks.release(block);
+    games[slot].owner = -1;
+    games.release(slot);
+}
+
+std::string GameServer::handle(int fd, std::string_view request){
+    //Split into the command, the game and whatever follows
+    auto nextWord = [&request](){
+        size_t start = request.find_first_not_of(' ');
+        if(start == std::string_view::npos)
+            return std::string_view();
+        size_t end = request.find(' ', start);
+        std::string_view word = request.substr(start, end == std::string_view::npos? std::string_view::npos : end - start);
+        request.remove_prefix(end == std::string_view::npos? request.size() : end);
+        return word;
+    };
+    std::string_view command = nextWord();
+
+    if(command == "new"){
+        if(games.inUse() >= maxGames)
+            return "error too many games";
+        ChessBoard board;
+        size_t start = request.find_first_not_of(' ');
+        if(start == std::string_view::npos)
+            newGame(&board);
+        else if(!setupPosition(&board, std::string(request.substr(start))))
+            return "error invalid fen";
+        int32_t slot = games.allocate();
+        games[slot].board = board;
+        games[slot].owner = fd;
+        connections[fd].games.push_back(slot);
+        return "ok " + std::to_string(slot);
+    }
+    if(command == "stats"){
+        if(nextWord() == "counters")
+            return "stats counters " + statsJson();
+        size_t bytes = games.size() * sizeof(Game) + blocks.size() * sizeof(MoveBlock);
+        return "stats games " + std::to_string(games.inUse()) + " connections " + std::to_string(connections.size())
+            + " bytes " + std::to_string(bytes);
+    }
+
+    std::string_view id = nextWord();
+    int32_t slot;
+    Game* game = findGame(fd, id, slot);
+    if(command != "move" && command != "moves" && command != "fen" && command != "history" && command != "close")
+        return "error unknown command";
+    if(game == nullptr)
+        return "error no game " + std::string(id);
+    std::string reply(command);
+    reply += " " + std::string(id);
+
+    if(command == "move"){
+        Move move = findMove(&game->board, nextWord());
+        if(move == NO_MOVE)
+            return "illegal " + std::string(id);
+        UndoRecord undo;
+        game->board.makeMove(move, undo);
+        record(*game, move);
+        return "ok " + std::string(id) + " " + statusReport(&game->board);
+    }
+    if(command == "moves"){
+        MoveList list;
+        generateLegalMoves(&game->board, list);
+        for(Move move: list)
+            reply += " " + moveToString(move);
+        return reply;
+    }
+    if(command == "fen")
+        return reply + " " + boardToFen(&game->board);
+    if(command == "history"){
+        int32_t block = game->firstBlock;
+        for(uint32_t ply = 0; ply < game->plies; ply++){
+            reply += " " + moveToString(blocks[block].moves[ply % MOVES_PER_BLOCK]);
+            if(ply % MOVES_PER_BLOCK == MOVES_PER_BLOCK - 1)
+                block = blocks[block].next;
+        }
+        return reply;
+    }
+    std::vector<int32_t>& owned = connections[fd].games;
+    for(size_t i = 0; i < owned.size(); i++){
+        if(owned[i] == slot){
+            owned[i] = owned.back();
+            owned.pop_back();
+            break;
+        }
+    }
+    closeGame(slot);
+    return "ok " + std::string(id);
+}
+
+void GameServer::closeConnection(int fd){
+    for(int32_t slot: connections[fd].games)
+        closeGame(slot);
+    connections.erase(fd);
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+}
+
+//Writes as much as the socket takes and waits for it to drain before writing the rest. A connection the client
+//has ended is closed once everything is written.
+void GameServer::writeTo(int fd){
+    Connection& connection = connections[fd];
+    size_t written = 0;
+    while(written < connection.output.size()){
+        ssize_t count = send(fd, connection.output.data() + written, connection.output.size() - written, MSG_NOSIGNAL);
+        if(count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+            closeConnection(fd);
+            return;
+        }
+        if(count <= 0)
+            break;
+        written += count;
+    }
+    connection.output.erase(0, written);
+    if(connection.ended && connection.output.empty()){
+        closeConnection(fd);
+        return;
+    }
+    //An ended connection always reads as ready, so it only waits to write
+    epoll_event event = {};
+    event.events = (connection.ended? uint32_t(0) : uint32_t(EPOLLIN)) | (connection.output.empty()? uint32_t(0) : uint32_t(EPOLLOUT));
+    event.data.fd = fd;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &event);
+}
+
+//Answers every complete line of input. Returns false, having closed the connection, when the client has gone
+//over the limits.
+bool GameServer::handleLines(int fd){
+    Connection& connection = connections[fd];
+    size_t start = 0, end;
+    while((end = connection.input.find('\n', start)) != std::string::npos){
+        std::string_view line(connection.input.data() + start, end - start);
+        if(!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if(line.size() > MAX_LINE){
+            closeConnection(fd);
+            return false;
+        }
+        if(!line.empty()){
+            std::string reply = handle(fd, line);
+            connection.output += reply;
+            connection.output += '\n';
+        }
+        start = end + 1;
+    }
+    connection.input.erase(0, start);
+    if(connection.input.size() > MAX_LINE || connection.output.size() > MAX_PENDING_OUTPUT){
+        closeConnection(fd);
+        return false;
+    }
+    return true;
+}
+
+//Reads whatever has arrived and answers every complete line in it. When the client has closed its end, the lines
+//before that are still answered.
+void GameServer::readFrom(int fd){
+    char buffer[65536];
+    while(true){
+        ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+        if(count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR){
+            closeConnection(fd);
+            return;
+        }
+        if(count < 0)
+            break;
+        if(count == 0){
+            connections[fd].ended = true;
+            break;
+        }
+        connections[fd].input.append(buffer, count);
+        //Lines are answered as they come so a fast client cannot pile up input between limit checks
+        if(!handleLines(fd))
+            return;
+    }
+    Connection& connection = connections[fd];
+    if(!connection.output.empty() || connection.ended)
+        writeTo(fd);
+}
+
+int GameServer::run(const char* path){
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if(listener < 0 || strlen(path) >= sizeof(address.sun_path)){
+        std::cout<<"Cannot create a socket at "<<path<<"\n";
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+    unlink(path);
+    if(bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 1024) != 0){
+        std::cout<<"Cannot listen on "<<path<<": "<<strerror(errno)<<"\n";
+        return 1;
+    }
+
+    epoll = epoll_create1(0);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listener;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+    std::cout<<"Listening on "<<path<<"\n"<<std::flush;
+
+    epoll_event events[256];
+    while(true){
+        int ready = epoll_wait(epoll, events, 256, -1);
+        if(ready < 0 && errno != EINTR)
+            break;
+        for(int i = 0; i < ready; i++){
+            int fd = events[i].data.fd;
+            if(fd == listener){
+                int client;
+                while((client = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK)) >= 0){
+                    connections[client];
+                    epoll_event added = {};
+                    added.events = EPOLLIN;
+                    added.data.fd = client;
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, client, &added);
+                }
+                continue;
+            }
+            if(connections.count(fd) == 0)
+                continue;
+            if(events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)){
+                closeConnection(fd);
+                continue;
+            }
+            if(events[i].events & EPOLLOUT)
+                writeTo(fd);
+            //Writing may have closed the connection
+            if((events[i].events & EPOLLIN) && connections.count(fd) > 0)
+                readFrom(fd);
+        }
+    }
+    close(listener);
+    unlink(path);
+    return 0;
+}
+
+int serverCommand(int argc, char* argv[]){
+    if(argc < 3){
+        std::cout<<"Usage: chess server <socket path> [max games]\n";
+        return 1;
+    }
+    GameServer server(argc > 3? atol(argv[3]) : 100000);
+    return server.run(argv[2]);
+}
@@ -0,0 +1,19 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+//Entry point for "chess server <socket path> [max games]", hosts games for clients of a local Unix socket.
+//Each request is one line and gets one line back:
+//  new [fen]             ok <game>
+//  move <game> <move>    ok <game> <status> | illegal <game>      moves in coordinate notation, e.g. e2e4 or e7e8q
+//                        status is none, check, checkmate, stalemate, insufficient-material or fifty-move-rule
+//  moves <game>          moves <game> <move>...
+//  fen <game>            fen <game> <fen>
+//  history <game>        history <game> <move>...
+//  close <game>          ok <game>
+//  stats                 stats games <count> connections <count> bytes <arena size>
+//  stats counters        stats counters <JSON of the counters and histograms in stats.h>
+//Anything wrong with a request is answered with "error <reason>". Games belong to the connection that
+//created them and are closed with it.
+int serverCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <thread>
+#include <cstdlib>
+#include "smp.h"
+#include "fen.h"
+
+ParallelSearch::ParallelSearch(ChessBoard* chessBoard, TranspositionTable& tt, const std::vector<uint64_t>& gameKeys, int threads): tt(tt){
+    for(int i = 0; i < (threads > 0? threads : 1); i++){
+        boards.emplace_back(new ChessBoard(*chessBoard));
+        searches.emplace_back(new Search(boards.back().get(), tt, gameKeys, &token));
+        if(i > 0)
+            searches.back()->makeHelper(i % 2);
+    }
+}
+
+uint64_t ParallelSearch::getNodes(){
+    uint64_t total = 0;
+    for(auto& search: searches)
+        total += search->getNodes();
+    return total;
+}
+
+Move ParallelSearch::run(const SearchLimits& limits){
+    tt.newSearch();
+    searches[0]->onIteration = [this](const SearchReport& report){
+        if(onIteration){
+            SearchReport total = report;
+            total.nodes = getNodes();
+            onIteration(total);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for(size_t i = 1; i < searches.size(); i++)
+        helpers.emplace_back([this, i, &limits]{searches[i]->run(limits);});
+    Move best = searches[0]->run(limits);
+    token.cancel();
+    for(std::thread& helper: helpers)
+        helper.join();
+    return best;
+}
+
+//Middlegame positions with plenty of play, so a fixed depth takes long enough to time
+static const char* scalingPositions[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+};
+
+int scalingCommand(int argc, char* argv[]){
+    int depth = (argc > 2? atoi(argv[2]) : 9);
+    int maxThreads = (argc > 3? atoi(argv[3]) : 32);
+    SearchLimits limits;
+    limits.depth = depth;
+    TranspositionTable tt(256);
+
+    double baseline = 0;
+    std::cout<<"threads\ttime (s)\tspeedup\tnodes\tnps\n";
+    for(int threads = 1; threads <= maxThreads; threads *= 2){
+        double seconds = 0;
+        uint64_t nodes = 0;
+        for(const char* fen: scalingPositions){
+            ChessBoard chessBoard;
+            setupPosition(&chessBoard, fen);
+            tt.clear();
+            ParallelSearch search(&chessBoard, tt, std::vector<uint64_t>(1, chessBoard.getKey()), threads);
+            auto start = std::chrono::steady_clock::now();
+            search.run(limits);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            nodes += search.getNodes();
+        }
+        if(threads == 1)
+            baseline = seconds;
+        std::cout<<threads<<"\t"<<seconds<<"\t"<<baseline / seconds<<"\t"<<nodes<<"\t"<<uint64_t(nodes / seconds)<<"\n";
+    }
+    return 0;
+}
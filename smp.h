@@ -0,0 +1,35 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "search.h"
+
+//Lazy SMP: every thread runs its own Search on its own copy of the board and they cooperate only through
+//the shared transposition table. The first thread keeps the clock and its result is the one played.
+class ParallelSearch{
+private:
+    std::vector<std::unique_ptr<ChessBoard>> boards;
+    std::vector<std::unique_ptr<Search>> searches;
+    TranspositionTable& tt;
+    CancellationToken token;
+public:
+    //Reports of the main thread, with the node count of all threads
+    std::function<void(const SearchReport&)> onIteration;
+    ParallelSearch(ChessBoard* chessBoard, TranspositionTable& tt, const std::vector<uint64_t>& gameKeys, int threads);
+    //Each ParallelSearch runs once, so a stop requested before run starts still counts
+    Move run(const SearchLimits& limits);
+    //Safe to call from any thread, the search returns its best move so far as soon as it notices
+    void requestStop() {token.cancel();}
+    //Called before run, the search goes on past its time until ponderHit or requestStop. After ponderHit it keeps
+    //the time of the limits counted from when run started, so a long wait for the hit means an instant reply.
+    void ponder() {token.setPondering(true);}
+    void ponderHit() {token.setPondering(false);}
+    uint64_t getNodes();
+};
+
+//Entry point for "chess smp [depth] [max threads]", reports the time-to-depth speedup for growing thread counts
+int scalingCommand(int argc, char* argv[]);
+
+#endif
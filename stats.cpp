@@ -0,0 +1,206 @@
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "stats.h"
+
+static const char* counterNames[STAT_COUNTERS] = {
+    "threat_queries", "legality_checks", "moves_made", "moves_unmade", "hash_probes", "hash_hits", "nodes"
+};
+static const char* histogramNames[STAT_HISTOGRAMS] = {"move_validation", "search"};
+
+//The blocks of running threads, and what finished threads counted
+static std::mutex registryLock;
+static std::vector<ThreadStats*> running;
+static ThreadStats finished;
+
+static void addInto(ThreadStats& total, const ThreadStats& stats){
+    for(int i = 0; i < STAT_COUNTERS; i++)
+        total.counters[i].store(total.counters[i].load(std::memory_order_relaxed) + stats.counters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for(int h = 0; h < STAT_HISTOGRAMS; h++){
+        for(int b = 0; b < HISTOGRAM_BUCKETS; b++)
+            total.buckets[h][b].store(total.buckets[h][b].load(std::memory_order_relaxed) + stats.buckets[h][b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+static void clear(ThreadStats& stats){
+    for(std::atomic<uint64_t>& counter: stats.counters)
+        counter.store(0, std::memory_order_relaxed);
+    for(auto& histogram: stats.buckets){
+        for(std::atomic<uint64_t>& count: histogram)
+            count.store(0, std::memory_order_relaxed);
+    }
+}
+
+//Hands the thread's counts over to finished when the thread ends
+struct ThreadRetirer{
+    ThreadStats* stats = nullptr;
+    ~ThreadRetirer(){
+        if(stats == nullptr)
+            return;
+        std::lock_guard<std::mutex> guard(registryLock);
+        addInto(finished, *stats);
+        for(size_t i = 0; i < running.size(); i++){
+            if(running[i] == stats){
+                running[i] = running.back();
+                running.pop_back();
+                break;
+            }
+        }
+        threadStats = nullptr;
+        delete stats;
+    }
+};
+static thread_local ThreadRetirer retirer;
+
+ThreadStats* registerThreadStats(){
+    ThreadStats* stats = new ThreadStats;
+    clear(*stats);
+    std::lock_guard<std::mutex> guard(registryLock);
+    running.push_back(stats);
+    retirer.stats = stats;
+    threadStats = stats;
+    return stats;
+}
+
+uint64_t histogramBucketValue(int bucket){
+    if(bucket < HISTOGRAM_SUB_BUCKETS)
+        return uint64_t(bucket);
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    return uint64_t(HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << shift;
+}
+
+bool statsEnabled(){
+#ifdef CHESS_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+//Adds up every thread; the total is too big for the stack
+static std::unique_ptr<ThreadStats> collect(){
+    std::unique_ptr<ThreadStats> total(new ThreadStats);
+    clear(*total);
+    std::lock_guard<std::mutex> guard(registryLock);
+    addInto(*total, finished);
+    for(ThreadStats* stats: running)
+        addInto(*total, *stats);
+    return total;
+}
+
+struct HistogramSummary{
+    uint64_t count = 0;
+    double mean = 0;
+    uint64_t percentiles[4] = {0, 0, 0, 0};
+    uint64_t max = 0;
+};
+static const double percentileRanks[4] = {50, 90, 99, 99.9};
+static const char* percentileNames[4] = {"p50", "p90", "p99", "p99.9"};
+
+static HistogramSummary summarize(const std::atomic<uint64_t> buckets[HISTOGRAM_BUCKETS]){
+    HistogramSummary summary;
+    double sum = 0;
+    for(int b = 0; b < HISTOGRAM_BUCKETS; b++){
+        uint64_t count = buckets[b].load(std::memory_order_relaxed);
+        summary.count += count;
+        sum += double(count) * histogramBucketValue(b);
+        if(count > 0)
+            summary.max = histogramBucketValue(b);
+    }
+    if(summary.count == 0)
+        return summary;
+    summary.mean = sum / summary.count;
+    for(int p = 0; p < 4; p++){
+        //The value below which the rank's share of the recordings fall
+        uint64_t wanted = uint64_t(percentileRanks[p] / 100 * summary.count + 0.5), seen = 0;
+        if(wanted < 1)
+            wanted = 1;
+        for(int b = 0; b < HISTOGRAM_BUCKETS; b++){
+            seen += buckets[b].load(std::memory_order_relaxed);
+            if(seen >= wanted){
+                summary.percentiles[p] = histogramBucketValue(b);
+                break;
+            }
+        }
+    }
+    return summary;
+}
+
+std::string statsText(){
+    if(!statsEnabled())
+        return "statistics are compiled out, build with CHESS_STATS to collect them\n";
+    std::unique_ptr<ThreadStats> total = collect();
+    std::ostringstream text;
+    for(int i = 0; i < STAT_COUNTERS; i++)
+        text<<counterNames[i]<<" "<<total->counters[i].load(std::memory_order_relaxed)<<"\n";
+    for(int h = 0; h < STAT_HISTOGRAMS; h++){
+        HistogramSummary summary = summarize(total->buckets[h]);
+        text<<histogramNames[h]<<" count "<<summary.count<<" mean "<<uint64_t(summary.mean);
+        for(int p = 0; p < 4; p++)
+            text<<" "<<percentileNames[p]<<" "<<summary.percentiles[p];
+        text<<" max "<<summary.max<<" ns\n";
+    }
+    return text.str();
+}
+
+std::string statsJson(){
+    if(!statsEnabled())
+        return "{\"enabled\": false}";
+    std::unique_ptr<ThreadStats> total = collect();
+    std::ostringstream json;
+    json<<"{\"enabled\": true, \"counters\": {";
+    for(int i = 0; i < STAT_COUNTERS; i++)
+        json<<(i > 0? ", " : "")<<"\""<<counterNames[i]<<"\": "<<total->counters[i].load(std::memory_order_relaxed);
+    json<<"}, \"histograms\": {";
+    for(int h = 0; h < STAT_HISTOGRAMS; h++){
+        HistogramSummary summary = summarize(total->buckets[h]);
+        json<<(h > 0? ", " : "")<<"\""<<histogramNames[h]<<"\": {\"count\": "<<summary.count<<", \"mean_ns\": "<<uint64_t(summary.mean);
+        for(int p = 0; p < 4; p++)
+            json<<", \""<<percentileNames[p]<<"_ns\": "<<summary.percentiles[p];
+        json<<", \"max_ns\": "<<summary.max<<"}";
+    }
+    json<<"}}";
+    return json.str();
+}
+
+void resetStats(){
+    std::lock_guard<std::mutex> guard(registryLock);
+    //Running threads may be counting, their next increments land on zeroed values a few counts late at worst
+    clear(finished);
+    for(ThreadStats* stats: running)
+        clear(*stats);
+}
+
+//Stops and joins the reporting thread when the program ends, with one last report of the whole run
+struct StatsReporter{
+    std::thread thread;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping = false;
+    ~StatsReporter(){
+        if(!thread.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        thread.join();
+        std::cerr<<statsText()<<std::flush;
+    }
+};
+static StatsReporter reporter;
+
+void reportStatsEvery(double seconds){
+    if(reporter.thread.joinable() || seconds <= 0)
+        return;
+    reporter.thread = std::thread([seconds](){
+        std::unique_lock<std::mutex> guard(reporter.lock);
+        while(!reporter.wake.wait_for(guard, std::chrono::duration<double>(seconds), [](){return reporter.stopping;}))
+            std::cerr<<statsText()<<std::flush;
+    });
+}
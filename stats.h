@@ -0,0 +1,116 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//Counters and latency histograms of the hot paths. They are only compiled in when CHESS_STATS is defined
+//(cmake -DCHESS_STATS=ON, or -DCHESS_STATS with g++); otherwise the STAT_ macros expand to nothing and the dumps
+//say so. Every thread counts into its own block, so counting is a plain load and store on a line no other
+//thread writes, and the blocks are only added up when the statistics are read.
+enum StatCounter{
+    STAT_THREAT_QUERIES, //isThreatened
+    STAT_LEGALITY_CHECKS, //Moves checked one at a time, as typed in the game or sent to the server
+    STAT_MOVES_MADE,
+    STAT_MOVES_UNMADE,
+    STAT_HASH_PROBES,
+    STAT_HASH_HITS,
+    STAT_NODES, //Searched, quiescence included
+    STAT_COUNTERS
+};
+
+enum StatHistogram{
+    STAT_MOVE_VALIDATION, //Time to check one move, in nanoseconds
+    STAT_SEARCH, //Time of one whole search, in nanoseconds
+    STAT_HISTOGRAMS
+};
+
+//Values below 2^HISTOGRAM_PRECISION have a bucket each; above, every power of two is split into
+//2^HISTOGRAM_PRECISION buckets, so a value is recorded to within about 3% whatever its size.
+const int HISTOGRAM_PRECISION = 5;
+const int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_PRECISION;
+const int HISTOGRAM_BUCKETS = (64 - HISTOGRAM_PRECISION + 1) * HISTOGRAM_SUB_BUCKETS;
+
+inline int histogramBucket(uint64_t value){
+    if(value < uint64_t(HISTOGRAM_SUB_BUCKETS))
+        return int(value);
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - HISTOGRAM_PRECISION;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + int((value >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+//The smallest value that falls in the bucket
+uint64_t histogramBucketValue(int bucket);
+
+//One thread's statistics. Only the owning thread writes them; readers may see them a few counts behind.
+struct ThreadStats{
+    std::atomic<uint64_t> counters[STAT_COUNTERS];
+    std::atomic<uint64_t> buckets[STAT_HISTOGRAMS][HISTOGRAM_BUCKETS];
+};
+
+//Null until the thread first counts something. Defined here so counting needs no call to reach it.
+inline thread_local ThreadStats* threadStats = nullptr;
+ThreadStats* registerThreadStats();
+
+//Returns the thread's new count
+inline uint64_t statAdd(int counter, uint64_t amount){
+    ThreadStats* stats = threadStats;
+    if(stats == nullptr)
+        stats = registerThreadStats();
+    std::atomic<uint64_t>& value = stats->counters[counter];
+    uint64_t updated = value.load(std::memory_order_relaxed) + amount;
+    value.store(updated, std::memory_order_relaxed);
+    return updated;
+}
+
+inline void statRecord(int histogram, uint64_t value){
+    ThreadStats* stats = threadStats;
+    if(stats == nullptr)
+        stats = registerThreadStats();
+    std::atomic<uint64_t>& count = stats->buckets[histogram][histogramBucket(value)];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+//Records the nanoseconds between its construction and the end of the enclosing scope, if active
+class StatTimer{
+private:
+    int histogram;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+public:
+    StatTimer(int histogram, bool active = true): histogram(histogram), active(active){
+        if(active)
+            start = std::chrono::steady_clock::now();
+    }
+    ~StatTimer(){
+        if(active)
+            statRecord(histogram, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+//Reading the clock costs more than checking most moves, so quick paths only time one call in STAT_SAMPLE_RATE
+const uint64_t STAT_SAMPLE_RATE = 64;
+
+#ifdef CHESS_STATS
+#define STAT_ADD(counter, amount) statAdd(counter, amount)
+#define STAT_TIMER(histogram) StatTimer statTimer(histogram)
+//Counts a call and times it when the count is a multiple of STAT_SAMPLE_RATE
+#define STAT_SAMPLED_TIMER(histogram, counter) StatTimer statTimer(histogram, statAdd(counter, 1) % STAT_SAMPLE_RATE == 0)
+#else
+#define STAT_ADD(counter, amount) ((void)0)
+#define STAT_TIMER(histogram) ((void)0)
+#define STAT_SAMPLED_TIMER(histogram, counter) ((void)0)
+#endif
+
+bool statsEnabled();
+//The counts of every thread so far, those that have finished included, as "name value" lines followed by
+//count, mean and percentiles of each histogram, or as one line of JSON
+std::string statsText();
+std::string statsJson();
+//Forgets everything counted so far
+void resetStats();
+//Writes statsText to standard error every interval seconds from a background thread, and once more as the program ends
+void reportStatsEvery(double seconds);
+
+#endif
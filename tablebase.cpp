@@ -0,0 +1,799 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "tablebase.h"
+#include "movegen.h"
+#include "fen.h"
+
+//A checkpoint of a table being generated: a TablebaseHeader with this magic, the positions and then the pending passes
+const char TABLEBASE_PARTIAL_MAGIC[8] = {'C', 'H', 'S', 'T', 'B', 'P', 'R', 'T'};
+//Piece types in the order they are named, strongest first
+const int NAME_ORDER[5] = {QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+//The longest mate a byte holds, one more ply would read as a draw
+const int LONGEST_MATE = TABLEBASE_DRAW - 1;
+
+//How the positions of one material configuration are numbered. Side 0 is the side named first, white in the table.
+struct TableLayout{
+    std::string name;
+    int counts[2][5] = {}; //Pieces other than the king, per side and type
+    uint64_t signature = 0;
+    bool pawns = false;
+    //The pieces other than the kings in the order they are indexed, identical pieces next to each other
+    int extra = 0;
+    int colors[TABLEBASE_MAX_PIECES - 2];
+    int types[TABLEBASE_MAX_PIECES - 2];
+    uint64_t half = 0; //Positions with one side to move
+};
+
+struct MappedTable{
+    TableLayout layout;
+    const uint8_t* positions;
+};
+
+//Filled before any search starts and only read afterwards, keyed by the signature of each table's material
+static std::unordered_map<uint64_t, MappedTable> tables;
+static int mostPieces = 0;
+
+//Four bits per side and piece type
+static uint64_t materialSignature(const int counts[2][5]){
+    uint64_t signature = 0;
+    for(int side = 0; side < 2; side++){
+        for(int type = PAWN; type <= QUEEN; type++)
+            signature |= uint64_t(counts[side][type]) << (4 * (side * 5 + type));
+    }
+    return signature;
+}
+
+//The signature of the pieces on the board with the given color as side 0
+static uint64_t boardSignature(ChessBoard* chessBoard, int white){
+    int counts[2][5];
+    for(int type = PAWN; type <= QUEEN; type++){
+        counts[0][type] = popCount(chessBoard->getPieces(white, type));
+        counts[1][type] = popCount(chessBoard->getPieces(-white, type));
+    }
+    return materialSignature(counts);
+}
+
+//More pieces is stronger, and between equal numbers the side with the better piece first
+static bool weaker(const int side[5], const int other[5]){
+    int total = 0, otherTotal = 0;
+    for(int type: NAME_ORDER){
+        total += side[type];
+        otherTotal += other[type];
+    }
+    if(total != otherTotal)
+        return total < otherTotal;
+    for(int type: NAME_ORDER){
+        if(side[type] != other[type])
+            return side[type] < other[type];
+    }
+    return false;
+}
+
+//Puts the stronger side first and works out the numbering
+static TableLayout makeLayout(const int material[2][5]){
+    TableLayout layout;
+    bool swap = weaker(material[0], material[1]);
+    for(int side = 0; side < 2; side++){
+        for(int type = PAWN; type <= QUEEN; type++)
+            layout.counts[side][type] = material[swap? 1 - side : side][type];
+    }
+    layout.half = 64;
+    for(int side = 0; side < 2; side++){
+        layout.name += (side == 0? "K" : "vK");
+        for(int type: NAME_ORDER){
+            for(int i = 0; i < layout.counts[side][type]; i++){
+                layout.name += "PNBRQ"[type];
+                layout.colors[layout.extra] = (side == 0? WHITE : BLACK);
+                layout.types[layout.extra++] = type;
+                layout.half *= (type == PAWN? 48 : 64);
+            }
+        }
+    }
+    layout.pawns = (layout.counts[0][PAWN] + layout.counts[1][PAWN] > 0);
+    layout.half *= (layout.pawns? 32 : 10);
+    layout.signature = materialSignature(layout.counts);
+    return layout;
+}
+
+//Reads a name like KRPvKR, in any order of the pieces
+static bool parseMaterial(const std::string& name, int counts[2][5]){
+    memset(counts, 0, sizeof(int) * 10);
+    size_t split = name.find('v');
+    if(split == std::string::npos || name[0] != 'K' || split + 1 >= name.size() || name[split + 1] != 'K')
+        return false;
+    int total = 0;
+    for(size_t i = 1; i < name.size(); i++){
+        if(i == split || i == split + 1)
+            continue;
+        const char* letter = strchr("PNBRQ", name[i]);
+        if(name[i] == 0 || letter == nullptr)
+            return false;
+        counts[i < split? 0 : 1][letter - "PNBRQ"]++;
+        total++;
+    }
+    return total <= TABLEBASE_MAX_PIECES - 2;
+}
+
+//The white king stands in the a1-d1-d4 triangle without pawns and on files a to d with them
+const int TRIANGLE_SQUARES[10] = {0, 1, 2, 3, 9, 10, 11, 18, 19, 27};
+
+static int kingIndex(int square, bool pawns){
+    if(pawns)
+        return square / 8 * 4 + square % 8;
+    for(int i = 0; i < 10; i++){
+        if(TRIANGLE_SQUARES[i] == square)
+            return i;
+    }
+    return -1;
+}
+
+static int kingFromIndex(int index, bool pawns){
+    return pawns? index / 4 * 8 + index % 4 : TRIANGLE_SQUARES[index];
+}
+
+//Bit 0 mirrors the files, bit 1 the ranks and bit 2 swaps files and ranks, applied in that order
+static int applySymmetry(int square, int symmetry){
+    int file = square % 8, rank = square / 8;
+    if(symmetry & 1)
+        file = 7 - file;
+    if(symmetry & 2)
+        rank = 7 - rank;
+    if(symmetry & 4)
+        std::swap(file, rank);
+    return rank * 8 + file;
+}
+
+//The symmetry that brings the white king to its allowed squares, pawns only allow mirroring the files
+static int kingSymmetry(int whiteKing, bool pawns){
+    int symmetry = (whiteKing % 8 > 3? 1 : 0);
+    if(pawns)
+        return symmetry;
+    if(applySymmetry(whiteKing, symmetry) / 8 > 3)
+        symmetry |= 2;
+    int square = applySymmetry(whiteKing, symmetry);
+    if(square / 8 > square % 8)
+        symmetry |= 4;
+    return symmetry;
+}
+
+//The index of a position under one symmetry, see positionIndex
+static uint64_t symmetricIndex(const TableLayout& layout, ChessBoard* chessBoard, int white, int symmetry){
+    int turnAround = (white == WHITE? 0 : 56);
+    uint64_t index = kingIndex(applySymmetry(chessBoard->kingSquare(white) ^ turnAround, symmetry), layout.pawns);
+    index = index * 64 + applySymmetry(chessBoard->kingSquare(-white) ^ turnAround, symmetry);
+    int squares[TABLEBASE_MAX_PIECES];
+    for(int i = 0; i < layout.extra; ){
+        int count = 0;
+        Bitboard b = chessBoard->getPieces(layout.colors[i] * white, layout.types[i]);
+        while(b)
+            squares[count++] = applySymmetry(popLsb(b) ^ turnAround, symmetry);
+        std::sort(squares, squares + count);
+        for(int j = 0; j < count; j++)
+            index = (layout.types[i] == PAWN? index * 48 + squares[j] - 8 : index * 64 + squares[j]);
+        i += count;
+    }
+    if(chessBoard->getTurn() != white)
+        index += layout.half;
+    return index;
+}
+
+//The index of a position whose material matches the layout with the given color as side 0. When that is black,
+//the board is turned around so black's pieces stand where white's would. A white king on the a1-h8 diagonal leaves
+//two ways to place the rest, and the one with the lower index is used, so that every symmetric image of a position
+//has the same index.
+static uint64_t positionIndex(const TableLayout& layout, ChessBoard* chessBoard, int white){
+    int whiteKing = chessBoard->kingSquare(white) ^ (white == WHITE? 0 : 56);
+    int symmetry = kingSymmetry(whiteKing, layout.pawns);
+    uint64_t index = symmetricIndex(layout, chessBoard, white, symmetry);
+    int square = applySymmetry(whiteKing, symmetry);
+    if(!layout.pawns && square / 8 == square % 8)
+        index = std::min(index, symmetricIndex(layout, chessBoard, white, symmetry | 4));
+    return index;
+}
+
+//Sets up the position an index stands for, false if it does not stand for a legal position or another index stands for it
+static bool setupIndex(const TableLayout& layout, uint64_t index, ChessBoard* chessBoard){
+    uint64_t original = index;
+    int turn = (index < layout.half? WHITE : BLACK);
+    index %= layout.half;
+    int squares[TABLEBASE_MAX_PIECES];
+    for(int i = layout.extra - 1; i >= 0; i--){
+        int radix = (layout.types[i] == PAWN? 48 : 64);
+        squares[i] = int(index % radix) + (layout.types[i] == PAWN? 8 : 0);
+        index /= radix;
+    }
+    int blackKing = int(index % 64), whiteKing = kingFromIndex(int(index / 64), layout.pawns);
+    Bitboard used = squareBB(whiteKing);
+    if(used & squareBB(blackKing))
+        return false;
+    used |= squareBB(blackKing);
+    for(int i = 0; i < layout.extra; i++){
+        if(used & squareBB(squares[i]))
+            return false;
+        if(i > 0 && layout.types[i] == layout.types[i - 1] && layout.colors[i] == layout.colors[i - 1] && squares[i] < squares[i - 1])
+            return false;
+        used |= squareBB(squares[i]);
+    }
+
+    *chessBoard = ChessBoard();
+    chessBoard->addPiece(makePiece(WHITE, KING), whiteKing);
+    chessBoard->addPiece(makePiece(BLACK, KING), blackKing);
+    for(int i = 0; i < layout.extra; i++)
+        chessBoard->addPiece(makePiece(layout.colors[i], layout.types[i]), squares[i]);
+    chessBoard->setTurn(turn);
+    chessBoard->finishSetup();
+    return chessBoard->attackersTo(chessBoard->kingSquare(turn * -1), turn) == 0 && positionIndex(layout, chessBoard, WHITE) == original;
+}
+
+//The code of a loaded table for the position, whatever its castling rights and en passant square
+static bool probeCode(ChessBoard* chessBoard, uint8_t& code){
+    for(int white = WHITE; white >= BLACK; white -= 2){
+        auto found = tables.find(boardSignature(chessBoard, white));
+        if(found != tables.end()){
+            code = found->second.positions[positionIndex(found->second.layout, chessBoard, white)];
+            return code != TABLEBASE_INVALID;
+        }
+    }
+    return false;
+}
+
+static bool enpassantPossible(ChessBoard* chessBoard){
+    int square = chessBoard->getEnpassantSquare(), turn = chessBoard->getTurn();
+    return square >= 0 && (pawnAttacks[colorIndex(turn * -1)][square] & chessBoard->getPieces(turn, PAWN)) != 0;
+}
+
+//The code of a position for the side that moved into it: one ply further from mate, won by the same side
+static uint8_t beforeMove(uint8_t code){
+    return code < LONGEST_MATE? code + 1 : TABLEBASE_DRAW;
+}
+
+//Higher is better for the side to move: quick mates, then draws, then long defences
+static int preference(uint8_t code){
+    if(code >= TABLEBASE_DRAW)
+        return 0;
+    return code % 2 != 0? 1000 - code : code - 1000;
+}
+
+static TablebaseResult codeResult(uint8_t code){
+    if(code >= TABLEBASE_DRAW)
+        return {0, 0};
+    return {code % 2 != 0? 1 : -1, code};
+}
+
+bool ChessBoard::probeTablebase(TablebaseResult& result){
+    //The tables leave out castling and en passant, so positions where either is possible are not in them
+    uint8_t code;
+    if(castlingRights != 0 || popCount(occupancy) > mostPieces || enpassantPossible(this) || !probeCode(this, code))
+        return false;
+    result = codeResult(code);
+    return true;
+}
+
+int tablebasePieces(){
+    return mostPieces;
+}
+
+Move tablebaseMove(ChessBoard* chessBoard, TablebaseResult& result){
+    MoveList list;
+    generateLegalMoves(chessBoard, list);
+    Move best = NO_MOVE;
+    uint8_t bestCode = TABLEBASE_INVALID;
+    UndoRecord undo;
+    for(Move move: list){
+        TablebaseResult reply;
+        chessBoard->makeMove(move, undo);
+        bool known = chessBoard->probeTablebase(reply);
+        chessBoard->unmakeMove(undo);
+        if(!known)
+            return NO_MOVE;
+        uint8_t code = beforeMove(reply.outcome == 0? TABLEBASE_DRAW : reply.plies);
+        if(best == NO_MOVE || preference(code) > preference(bestCode)){
+            best = move;
+            bestCode = code;
+        }
+    }
+    if(best != NO_MOVE)
+        result = codeResult(bestCode);
+    return best;
+}
+
+std::string describeResult(ChessBoard* chessBoard, const TablebaseResult& result){
+    if(result.outcome == 0)
+        return "draw";
+    if(result.plies == 0)
+        return "checkmate";
+    bool whiteWins = ((result.outcome > 0) == (chessBoard->getTurn() == WHITE));
+    return std::string(whiteWins? "white" : "black") + " mates in " + std::to_string((result.plies + 1) / 2);
+}
+
+//Maps one table file and registers it under its material
+static bool mapTable(const std::string& path){
+    int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if(fd < 0)
+        return false;
+    if(fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(TablebaseHeader)){
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED)
+        return false;
+    const TablebaseHeader* header = (const TablebaseHeader*)mapping;
+    int counts[2][5];
+    std::string name(header->name, strnlen(header->name, sizeof(header->name)));
+    if(memcmp(header->magic, TABLEBASE_MAGIC, sizeof(TABLEBASE_MAGIC)) != 0 || !parseMaterial(name, counts)){
+        munmap(mapping, info.st_size);
+        return false;
+    }
+    TableLayout layout = makeLayout(counts);
+    if(layout.half * 2 != header->positions || size_t(info.st_size) < sizeof(TablebaseHeader) + header->positions){
+        munmap(mapping, info.st_size);
+        return false;
+    }
+    tables[layout.signature] = MappedTable{layout, (const uint8_t*)mapping + sizeof(TablebaseHeader)};
+    mostPieces = std::max(mostPieces, layout.extra + 2);
+    return true;
+}
+
+static std::string tablePath(const std::string& directory, const std::string& name){
+    return directory + "/" + name + ".tb";
+}
+
+int loadTablebases(const std::string& directory){
+    DIR* entries = opendir(directory.c_str());
+    if(entries == nullptr)
+        return int(tables.size());
+    while(dirent* entry = readdir(entries)){
+        std::string file = entry->d_name;
+        int counts[2][5];
+        if(file.size() < 4 || file.compare(file.size() - 3, 3, ".tb") != 0 || !parseMaterial(file.substr(0, file.size() - 3), counts))
+            continue;
+        if(tables.count(makeLayout(counts).signature) == 0)
+            mapTable(directory + "/" + file);
+    }
+    closedir(entries);
+    return int(tables.size());
+}
+
+//Hands out [0, size) to the threads in chunks, a multiple of 64 so each thread owns whole words of a bit set
+static void parallelFor(uint64_t size, int threads, const std::function<void(uint64_t, uint64_t, int)>& work){
+    const uint64_t CHUNK = 1 << 16;
+    std::atomic<uint64_t> next{0};
+    auto run = [&](int worker){
+        for(uint64_t begin = next.fetch_add(CHUNK); begin < size; begin = next.fetch_add(CHUNK))
+            work(begin, std::min(begin + CHUNK, size), worker);
+    };
+    std::vector<std::thread> workers;
+    for(int i = 1; i < threads; i++)
+        workers.emplace_back(run, i);
+    run(0);
+    for(std::thread& worker: workers)
+        worker.join();
+}
+
+//Builds one table by retrograde analysis. Checkmates are found first, then pass n decides the positions that are
+//n plies from mate: those with a move to a position lost in n - 1, and those where every move leads to a position the
+//opponent wins in at most n - 1. A pass only looks at the positions one quiet move before those decided by the last
+//pass, found by taking moves back, and at positions that a capture or promotion into a smaller table decides then.
+//Positions still undecided when no pass finds any more are draws.
+class TableGenerator{
+private:
+    const TableLayout& layout;
+    std::string path;
+    int threads;
+    uint64_t size;
+    //TABLEBASE_DRAW stands for undecided until the end
+    std::vector<uint8_t> values;
+    //The pass at which a move out of the table can decide each position, 0 for none
+    std::vector<uint8_t> pending;
+    std::unique_ptr<std::atomic<uint64_t>[]> marks;
+    int pass = 0;
+    int lastPending = 0;
+    std::chrono::steady_clock::time_point lastCheckpoint;
+
+    uint8_t outsideCode(ChessBoard* chessBoard, bool inside);
+    uint8_t successorCode(ChessBoard* chessBoard);
+    void mark(uint64_t index) {marks[index / 64].fetch_or(1ULL << (index % 64), std::memory_order_relaxed);}
+    void markPredecessors(uint64_t index);
+    bool decidedNow(uint64_t index);
+    void findMates();
+    bool resume();
+    bool checkpoint();
+    bool save(int longest);
+public:
+    TableGenerator(const TableLayout& layout, const std::string& directory, int threads):
+    layout(layout), path(tablePath(directory, layout.name)), threads(threads), size(layout.half * 2) {}
+    bool run();
+};
+
+//What a position after a move is worth beyond this table, for the side then to move: the smaller table after a capture
+//or promotion, or the best en passant capture when one is possible. TABLEBASE_INVALID if nothing leads out.
+uint8_t TableGenerator::outsideCode(ChessBoard* chessBoard, bool inside){
+    uint8_t code = TABLEBASE_INVALID;
+    if(!inside){
+        probeCode(chessBoard, code);
+        return code;
+    }
+    if(!enpassantPossible(chessBoard))
+        return code;
+    MoveList list;
+    generateLegalMoves(chessBoard, list, true);
+    UndoRecord undo;
+    for(Move move: list){
+        if(moveFlag(move) != MOVE_EN_PASSANT)
+            continue;
+        uint8_t captured;
+        chessBoard->makeMove(move, undo);
+        bool known = probeCode(chessBoard, captured);
+        chessBoard->unmakeMove(undo);
+        if(known && (code == TABLEBASE_INVALID || preference(beforeMove(captured)) > preference(code)))
+            code = beforeMove(captured);
+    }
+    return code;
+}
+
+//The position after a move, for the side then to move, as far as it is known
+uint8_t TableGenerator::successorCode(ChessBoard* chessBoard){
+    bool inside = (boardSignature(chessBoard, WHITE) == layout.signature);
+    uint8_t outside = outsideCode(chessBoard, inside);
+    if(!inside)
+        return outside;
+    uint8_t code = values[positionIndex(layout, chessBoard, WHITE)];
+    if(outside != TABLEBASE_INVALID && preference(outside) > preference(code))
+        code = outside;
+    return code;
+}
+
+//Takes back every quiet move of the side that has just moved and marks the positions before it
+void TableGenerator::markPredecessors(uint64_t index){
+    ChessBoard chessBoard;
+    setupIndex(layout, index, &chessBoard);
+    Piece* board = chessBoard.getBoard();
+    int mover = chessBoard.getTurn() * -1;
+    Bitboard occupied = chessBoard.getOccupancy();
+    chessBoard.setTurn(mover);
+    Bitboard own = chessBoard.getColorPieces(mover);
+    while(own){
+        int square = popLsb(own);
+        Bitboard sources = 0;
+        switch(pieceType(board[square])){
+        case PAWN:{
+            int back = square - 8 * mover;
+            if(back / 8 != 0 && back / 8 != 7 && board[back] == NO_PIECE){
+                sources = squareBB(back);
+                if(square / 8 == (mover == WHITE? 3 : 4) && board[back - 8 * mover] == NO_PIECE)
+                    sources |= squareBB(back - 8 * mover);
+            }
+            break;
+        }
+        case KNIGHT: sources = knightAttacks[square] & ~occupied; break;
+        case BISHOP: sources = bishopAttacks(square, occupied) & ~occupied; break;
+        case ROOK: sources = rookAttacks(square, occupied) & ~occupied; break;
+        case QUEEN: sources = queenAttacks(square, occupied) & ~occupied; break;
+        case KING: sources = kingAttacks[square] & ~occupied; break;
+        }
+        while(sources){
+            int source = popLsb(sources);
+            chessBoard.movePiece(square, source);
+            mark(positionIndex(layout, &chessBoard, WHITE));
+            chessBoard.movePiece(source, square);
+        }
+    }
+}
+
+//Whether the undecided position is decided in exactly this pass
+bool TableGenerator::decidedNow(uint64_t index){
+    ChessBoard chessBoard;
+    setupIndex(layout, index, &chessBoard);
+    MoveList list;
+    generateLegalMoves(&chessBoard, list);
+    if(list.size() == 0)
+        return false;
+    bool win = (pass % 2 != 0);
+    UndoRecord undo;
+    for(Move move: list){
+        chessBoard.makeMove(move, undo);
+        uint8_t code = beforeMove(successorCode(&chessBoard));
+        chessBoard.unmakeMove(undo);
+        if(win && code == pass)
+            return true;
+        if(!win && (code % 2 != 0 || code > pass))
+            return false;
+    }
+    return !win;
+}
+
+//Pass 0 finds every checkmate and works out when moves out of the table can decide each position: the quickest
+//win through one, or the longest loss when at least one loses
+void TableGenerator::findMates(){
+    values.assign(size, TABLEBASE_DRAW);
+    pending.assign(size, 0);
+    std::vector<int> latest(threads, 0);
+    parallelFor(size, threads, [&](uint64_t begin, uint64_t end, int worker){
+        ChessBoard chessBoard;
+        MoveList list;
+        UndoRecord undo;
+        for(uint64_t index = begin; index < end; index++){
+            if(!setupIndex(layout, index, &chessBoard)){
+                values[index] = TABLEBASE_INVALID;
+                continue;
+            }
+            list.count = 0;
+            generateLegalMoves(&chessBoard, list);
+            if(list.size() == 0 && chessBoard.inCheck())
+                values[index] = 0;
+            int win = 0, loss = 0;
+            for(Move move: list){
+                chessBoard.makeMove(move, undo);
+                uint8_t code = outsideCode(&chessBoard, boardSignature(&chessBoard, WHITE) == layout.signature);
+                chessBoard.unmakeMove(undo);
+                code = (code == TABLEBASE_INVALID? TABLEBASE_DRAW : beforeMove(code));
+                if(code < TABLEBASE_DRAW && code % 2 != 0 && (win == 0 || code < win))
+                    win = code;
+                if(code < TABLEBASE_DRAW && code % 2 == 0 && code > loss)
+                    loss = code;
+            }
+            pending[index] = uint8_t(win != 0? win : loss);
+            latest[worker] = std::max(latest[worker], int(pending[index]));
+        }
+    });
+    lastPending = *std::max_element(latest.begin(), latest.end());
+}
+
+bool TableGenerator::resume(){
+    std::ifstream file(path + ".part", std::ios::binary);
+    TablebaseHeader header;
+    if(!file.read((char*)&header, sizeof(header)) || memcmp(header.magic, TABLEBASE_PARTIAL_MAGIC, sizeof(header.magic)) != 0
+    || std::string(header.name, strnlen(header.name, sizeof(header.name))) != layout.name || header.positions != size)
+        return false;
+    values.resize(size);
+    pending.resize(size);
+    if(!file.read((char*)values.data(), size) || !file.read((char*)pending.data(), size))
+        return false;
+    pass = header.longest;
+    lastPending = header.reserved;
+    //What was just read is what a checkpoint now would write, so the next one is a minute away
+    lastCheckpoint = std::chrono::steady_clock::now();
+    std::cout<<layout.name<<": resuming after ply "<<pass<<"\n";
+    return true;
+}
+
+//Written to a temporary file and renamed, so an interruption leaves the last checkpoint whole
+bool TableGenerator::checkpoint(){
+    TablebaseHeader header = {};
+    memcpy(header.magic, TABLEBASE_PARTIAL_MAGIC, sizeof(header.magic));
+    snprintf(header.name, sizeof(header.name), "%s", layout.name.c_str());
+    header.positions = size;
+    header.longest = pass;
+    header.reserved = lastPending;
+    {
+        std::ofstream file(path + ".part.tmp", std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)values.data(), size);
+        file.write((const char*)pending.data(), size);
+        if(!file)
+            return false;
+    }
+    lastCheckpoint = std::chrono::steady_clock::now();
+    return rename((path + ".part.tmp").c_str(), (path + ".part").c_str()) == 0;
+}
+
+bool TableGenerator::save(int longest){
+    TablebaseHeader header = {};
+    memcpy(header.magic, TABLEBASE_MAGIC, sizeof(header.magic));
+    snprintf(header.name, sizeof(header.name), "%s", layout.name.c_str());
+    header.positions = size;
+    header.longest = longest;
+    {
+        std::ofstream file(path + ".tmp", std::ios::binary | std::ios::trunc);
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)values.data(), size);
+        if(!file)
+            return false;
+    }
+    if(rename((path + ".tmp").c_str(), path.c_str()) != 0)
+        return false;
+    remove((path + ".part").c_str());
+    return true;
+}
+
+bool TableGenerator::run(){
+    auto start = std::chrono::steady_clock::now();
+    if(!resume()){
+        findMates();
+        if(!checkpoint()){
+            std::cout<<"Cannot write "<<path<<".part\n";
+            return false;
+        }
+    }
+    marks.reset(new std::atomic<uint64_t>[(size + 63) / 64]());
+    std::vector<std::vector<uint64_t>> decided(threads);
+    uint64_t found = 1;
+    while(pass < LONGEST_MATE && (found > 0 || pass < lastPending)){
+        pass++;
+        parallelFor(size, threads, [&](uint64_t begin, uint64_t end, int){
+            for(uint64_t index = begin; index < end; index++){
+                if(values[index] == pass - 1)
+                    markPredecessors(index);
+                if(pending[index] == pass)
+                    mark(index);
+            }
+        });
+        //Results are only written once every thread is done, so all of them see the table as the last pass left it
+        parallelFor(size, threads, [&](uint64_t begin, uint64_t end, int worker){
+            for(uint64_t word = begin / 64; word < (end + 63) / 64; word++){
+                uint64_t bits = marks[word].exchange(0, std::memory_order_relaxed);
+                while(bits){
+                    uint64_t index = word * 64 + popLsb(bits);
+                    if(values[index] == TABLEBASE_DRAW && decidedNow(index))
+                        decided[worker].push_back(index);
+                }
+            }
+        });
+        found = 0;
+        for(std::vector<uint64_t>& indices: decided){
+            for(uint64_t index: indices)
+                values[index] = uint8_t(pass);
+            found += indices.size();
+            indices.clear();
+        }
+        std::cout<<"\r"<<layout.name<<": ply "<<pass<<", "<<found<<" positions decided      "<<std::flush;
+        if(std::chrono::steady_clock::now() - lastCheckpoint > std::chrono::seconds(60))
+            checkpoint();
+    }
+    if(found > 0)
+        std::cout<<"\n"<<layout.name<<": mates longer than "<<LONGEST_MATE<<" plies are stored as draws";
+
+    uint64_t wins = 0, losses = 0, draws = 0;
+    int longest = 0;
+    for(uint8_t code: values){
+        if(code == TABLEBASE_DRAW)
+            draws++;
+        else if(code != TABLEBASE_INVALID){
+            (code % 2 != 0? wins : losses)++;
+            longest = std::max(longest, int(code));
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout<<"\r"<<layout.name<<": "<<wins<<" wins, "<<losses<<" losses, "<<draws<<" draws for the side to move, longest mate "
+    <<longest<<" plies, "<<seconds<<" s\n";
+    if(!save(longest)){
+        std::cout<<"Cannot write "<<path<<"\n";
+        return false;
+    }
+    return true;
+}
+
+//Generates a table once every table its captures and promotions lead to exists
+static bool buildTable(const std::string& directory, const int material[2][5], int threads){
+    TableLayout layout = makeLayout(material);
+    if(tables.count(layout.signature) != 0 || mapTable(tablePath(directory, layout.name)))
+        return true;
+    for(int side = 0; side < 2; side++){
+        for(int type = PAWN; type <= QUEEN; type++){
+            if(layout.counts[side][type] == 0)
+                continue;
+            int smaller[2][5];
+            memcpy(smaller, layout.counts, sizeof(smaller));
+            smaller[side][type]--;
+            if(!buildTable(directory, smaller, threads))
+                return false;
+            for(int promoted = KNIGHT; promoted <= QUEEN && type == PAWN; promoted++){
+                smaller[side][promoted]++;
+                if(!buildTable(directory, smaller, threads))
+                    return false;
+                smaller[side][promoted]--;
+            }
+        }
+    }
+    TableGenerator generator(layout, directory, threads);
+    return generator.run() && mapTable(tablePath(directory, layout.name));
+}
+
+//Every material configuration with from 3 up to the given number of pieces, smallest first
+static std::vector<std::string> configurations(int pieces){
+    std::vector<std::vector<int>> sides;
+    for(int q = 0; q <= 3; q++)
+        for(int r = 0; r <= 3; r++)
+            for(int b = 0; b <= 3; b++)
+                for(int n = 0; n <= 3; n++)
+                    for(int p = 0; p <= 3; p++){
+                        if(q + r + b + n + p <= pieces - 2)
+                            sides.push_back({p, n, b, r, q});
+                    }
+    std::set<std::string> names;
+    for(const std::vector<int>& first: sides){
+        for(const std::vector<int>& second: sides){
+            int material[2][5], total = 0;
+            for(int type = PAWN; type <= QUEEN; type++){
+                material[0][type] = first[type];
+                material[1][type] = second[type];
+                total += first[type] + second[type];
+            }
+            if(total >= 1 && total <= pieces - 2)
+                names.insert(makeLayout(material).name);
+        }
+    }
+    std::vector<std::string> ordered(names.begin(), names.end());
+    std::stable_sort(ordered.begin(), ordered.end(), [](const std::string& a, const std::string& b){return a.size() < b.size();});
+    return ordered;
+}
+
+static int generateCommand(int argc, char* argv[]){
+    std::string directory = argv[3];
+    mkdir(directory.c_str(), 0755);
+    std::string what = (argc > 4? argv[4] : std::to_string(TABLEBASE_MAX_PIECES));
+    int threads = (argc > 5? atoi(argv[5]) : int(std::thread::hardware_concurrency()));
+    if(threads < 1)
+        threads = 1;
+
+    std::vector<std::string> names;
+    int material[2][5];
+    if(parseMaterial(what, material))
+        names.push_back(what);
+    else if(atoi(what.c_str()) >= 3 && atoi(what.c_str()) <= TABLEBASE_MAX_PIECES)
+        names = configurations(atoi(what.c_str()));
+    else{
+        std::cout<<"Give a number of pieces from 3 to "<<TABLEBASE_MAX_PIECES<<" or a material such as KRPvKR\n";
+        return 1;
+    }
+    loadTablebases(directory);
+    for(size_t i = 0; i < names.size(); i++){
+        parseMaterial(names[i], material);
+        std::cout<<"["<<i + 1<<"/"<<names.size()<<"] "<<makeLayout(material).name<<"\n";
+        if(!buildTable(directory, material, threads))
+            return 1;
+    }
+    return 0;
+}
+
+static int probeCommand(int argc, char* argv[]){
+    std::string fen;
+    for(int i = 4; i < argc; i++)
+        fen += std::string(i > 4? " " : "") + argv[i];
+    ChessBoard chessBoard;
+    if(!setupPosition(&chessBoard, fen)){
+        std::cout<<"Invalid FEN\n";
+        return 1;
+    }
+    std::cout<<loadTablebases(argv[3])<<" tables loaded\n";
+    TablebaseResult result;
+    if(!chessBoard.probeTablebase(result)){
+        std::cout<<"The position is not in the tables\n";
+        return 1;
+    }
+    std::cout<<describeResult(&chessBoard, result)<<"\n";
+    Move best = tablebaseMove(&chessBoard, result);
+    if(best != NO_MOVE)
+        std::cout<<"best move "<<moveToString(best)<<"\n";
+    return 0;
+}
+
+int tablebaseCommand(int argc, char* argv[]){
+    if(argc > 3 && std::string(argv[2]) == "generate")
+        return generateCommand(argc, argv);
+    if(argc > 4 && std::string(argv[2]) == "probe")
+        return probeCommand(argc, argv);
+    std::cout<<"Usage: chess tablebase generate <directory> [pieces|material] [threads]\n"
+    <<"       chess tablebase probe <directory> <fen>\n";
+    return 1;
+}
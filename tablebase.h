@@ -0,0 +1,46 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include <string>
+#include "chess.h"
+
+//An endgame table holds every position of one material configuration, named like KRPvKR with the stronger side first.
+//A position takes one byte: the plies until mate with the side to move winning when it is odd and losing when it is even,
+//or TABLEBASE_DRAW. Castling and en passant are left out, and the fifty-move rule is not taken into account.
+//
+//Positions without pawns are mirrored so the white king stands in the a1-d1-d4 triangle, positions with pawns so that
+//it stands on the queen side. Pawns only take the 48 squares they can stand on, and identical pieces are stored in
+//ascending square order. The file is a TablebaseHeader followed by the positions with white to move, then black to move.
+const char TABLEBASE_MAGIC[8] = {'C', 'H', 'S', 'T', 'B', 'L', 'E', '1'};
+const int TABLEBASE_MAX_PIECES = 5;
+const uint8_t TABLEBASE_DRAW = 254;
+const uint8_t TABLEBASE_INVALID = 255;
+
+struct TablebaseHeader{
+    char magic[8];
+    char name[16];
+    uint64_t positions;
+    uint32_t longest; //Plies of the longest mate
+    uint32_t reserved;
+};
+
+//What the tables know about a position, for the side to move
+struct TablebaseResult{
+    int outcome; //1 mates, -1 is mated, 0 a draw
+    int plies; //Until mate, 0 for a draw
+};
+
+//Maps every table file in directory, leaving tables already mapped in place, and returns the number of tables mapped.
+//Tables must all be loaded before any search starts, probing does not lock.
+int loadTablebases(const std::string& directory);
+//The most pieces, kings included, of any loaded table, 0 when none is loaded
+int tablebasePieces();
+//The legal move that mates soonest, keeps the draw or holds out longest, or NO_MOVE when not every reply is in the tables
+Move tablebaseMove(ChessBoard* chessBoard, TablebaseResult& result);
+//E.g. "white mates in 12" or "draw"
+std::string describeResult(ChessBoard* chessBoard, const TablebaseResult& result);
+
+//Entry point for "chess tablebase generate <directory> [pieces|material] [threads]" and "chess tablebase probe <directory> <fen>"
+int tablebaseCommand(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,91 @@
+#include "tt.h"
+#include "stats.h"
+
+//Layout of the data word: move 0-15, score 16-31, eval 32-47, depth 48-55, bound 56-57, generation 58-63
+static uint64_t pack(Move move, int score, int eval, int depth, int bound, int generation){
+    return uint64_t(move) | uint64_t(uint16_t(int16_t(score))) << 16 | uint64_t(uint16_t(int16_t(eval))) << 32
+        | uint64_t(uint8_t(depth)) << 48 | uint64_t(bound) << 56 | uint64_t(generation) << 58;
+}
+
+static int packedDepth(uint64_t data) {return int8_t(data >> 48);}
+static int packedGeneration(uint64_t data) {return int(data >> 58);}
+
+TranspositionTable::~TranspositionTable(){
+    delete[] buckets;
+}
+
+void TranspositionTable::resize(size_t megabytes){
+    size_t count = 1;
+    while(count * 2 * sizeof(Bucket) <= megabytes * 1024 * 1024)
+        count *= 2;
+    delete[] buckets;
+    buckets = new Bucket[count];
+    bucketMask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear(){
+    for(size_t i = 0; i <= bucketMask; i++){
+        for(Entry& entry: buckets[i].entries){
+            entry.keyXorData.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData& found) const{
+    STAT_ADD(STAT_HASH_PROBES, 1);
+    for(Entry& entry: bucketFor(key).entries){
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if((entry.keyXorData.load(std::memory_order_relaxed) ^ data) != key || data == 0)
+            continue;
+        found.move = Move(data & 0xFFFF);
+        found.score = int16_t(data >> 16);
+        found.eval = int16_t(data >> 32);
+        found.depth = packedDepth(data);
+        found.bound = int(data >> 56) & 3;
+        STAT_ADD(STAT_HASH_HITS, 1);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int eval, int depth, int bound){
+    Entry* replace = nullptr;
+    int worst = 1 << 30;
+    for(Entry& entry: bucketFor(key).entries){
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if((entry.keyXorData.load(std::memory_order_relaxed) ^ data) == key){
+            //Keep the old best move when the new result has none, and do not let a shallow result overwrite a deeper exact one
+            if(move == NO_MOVE)
+                move = Move(data & 0xFFFF);
+            if(bound != BOUND_EXACT && depth < packedDepth(data) - 2 && packedGeneration(data) == generation)
+                return;
+            replace = &entry;
+            break;
+        }
+        //Otherwise replace the shallowest entry, counting entries from older searches as eight plies shallower
+        int age = (generation - packedGeneration(data)) & 63;
+        int value = (data == 0? -1000 : packedDepth(data) - 8 * age);
+        if(value < worst){
+            worst = value;
+            replace = &entry;
+        }
+    }
+    uint64_t data = pack(move, score, eval, depth, bound, generation);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const{
+    int used = 0;
+    for(size_t i = 0; i < 250 && i <= bucketMask; i++){
+        for(Entry& entry: buckets[i].entries){
+            uint64_t data = entry.data.load(std::memory_order_relaxed);
+            if(data != 0 && packedGeneration(data) == generation)
+                used++;
+        }
+    }
+    return used;
+}
@@ -0,0 +1,56 @@
+#ifndef TT_H
+#define TT_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "move.h"
+
+//Which side of the true score a stored score is on
+const int BOUND_NONE = 0;
+const int BOUND_UPPER = 1;
+const int BOUND_LOWER = 2;
+const int BOUND_EXACT = 3;
+
+struct TTData{
+    Move move;
+    int score;
+    int eval;
+    int depth;
+    int bound;
+};
+
+//A fixed-size hash table of search results shared by any number of threads without locks.
+//Each entry is two 64-bit words, the packed data and the key XORed with it. A reader that catches
+//another thread half way through a store sees a key that does not match and treats it as a miss.
+class TranspositionTable{
+private:
+    struct Entry{
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+    //Four entries fill one cache line, so a probe costs a single memory access
+    struct alignas(64) Bucket{
+        Entry entries[4];
+    };
+    Bucket* buckets = nullptr;
+    size_t bucketMask = 0;
+    uint8_t generation = 0;
+    Bucket& bucketFor(uint64_t key) const {return buckets[key & bucketMask];}
+public:
+    TranspositionTable(size_t megabytes = 16) {resize(megabytes);}
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+    ~TranspositionTable();
+    //Rounds down to a power of two number of buckets and clears the table
+    void resize(size_t megabytes);
+    void clear();
+    //Called once per search so entries from earlier searches are replaced first
+    void newSearch() {generation = (generation + 1) & 63;}
+    bool probe(uint64_t key, TTData& found) const;
+    void store(uint64_t key, Move move, int score, int eval, int depth, int bound);
+    //Permille of a sample of entries written during the current search
+    int hashfull() const;
+};
+
+#endif
@@ -0,0 +1,334 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <random>
+#include "uci.h"
+#include "fen.h"
+#include "movegen.h"
+#include "smp.h"
+#include "stats.h"
+#include "zobrist.h"
+#include "tablebase.h"
+#include "book.h"
+#include "nnue.h"
+
+//Time kept back from every move for the GUI to receive it, in milliseconds
+const int MOVE_OVERHEAD = 30;
+
+//Both the input and the search thread write, so lines are collected under a lock and each response goes out
+//with a single write and flush once it is complete, rather than a flush per line
+class UciOutput{
+private:
+    std::mutex lock;
+    std::string buffer;
+public:
+    void line(const std::string& text){
+        std::lock_guard<std::mutex> guard(lock);
+        buffer += text;
+        buffer += '\n';
+    }
+    void flush(){
+        std::lock_guard<std::mutex> guard(lock);
+        fwrite(buffer.data(), 1, buffer.size(), stdout);
+        fflush(stdout);
+        buffer.clear();
+    }
+    void send(const std::string& text){
+        line(text);
+        flush();
+    }
+};
+
+//Commands are read and handled on the calling thread while a search runs on a thread of its own,
+//so stop and isready are answered at once whatever the search is doing
+class UciEngine{
+private:
+    UciOutput out;
+    ChessBoard chessBoard;
+    std::vector<uint64_t> keys;
+    TranspositionTable tt;
+    int threads = 1;
+    OpeningBook book;
+    std::mt19937_64 random{std::random_device{}()};
+    std::unique_ptr<ParallelSearch> search;
+    std::thread searchThread;
+    //An infinite search may only send its best move once told to stop, a pondering one once told to stop or
+    //that the expected move was played
+    std::mutex stopLock;
+    std::condition_variable stopped;
+    bool stopRequested = false;
+    bool infinite = false;
+    bool pondering = false;
+    //The reply the last completed iteration expects, sent with the best move for the GUI to ponder on
+    Move ponderMove = NO_MOVE;
+
+    void position(std::istringstream& command);
+    void go(std::istringstream& command);
+    void setOption(std::istringstream& command);
+    void stopSearch();
+    void ponderHit();
+public:
+    UciEngine(): tt(16) {}
+    int loop();
+};
+
+static std::string formatInfo(const SearchReport& report, int hashfull){
+    std::string text = "info depth " + std::to_string(report.depth) + " score ";
+    if(abs(report.score) >= MATE_BOUND){
+        int moves = (MATE_SCORE - abs(report.score) + 1) / 2;
+        text += "mate " + std::to_string(report.score > 0? moves : -moves);
+    }
+    else
+        text += "cp " + std::to_string(report.score);
+    uint64_t nps = report.nodes * 1000 / (report.time > 0? report.time : 1);
+    text += " nodes " + std::to_string(report.nodes) + " nps " + std::to_string(nps) + " time " + std::to_string(report.time)
+        + " hashfull " + std::to_string(hashfull) + " pv";
+    for(Move move: report.pv)
+        text += " " + moveToString(move);
+    return text;
+}
+
+//"position startpos|fen <fen> [moves <move>...]", moves in coordinate notation such as e2e4 and e7e8q
+void UciEngine::position(std::istringstream& command){
+    //Built on a copy, so a command with a bad FEN or move leaves the engine on the position it had
+    std::string token, fen;
+    ChessBoard parsed;
+    command>>token;
+    if(token == "startpos"){
+        newGame(&parsed);
+        command>>token;
+    }
+    else if(token == "fen"){
+        while(command>>token && token != "moves")
+            fen += token + " ";
+        if(!setupPosition(&parsed, fen)){
+            out.send("info string invalid fen " + fen);
+            return;
+        }
+    }
+    else
+        return;
+
+    std::vector<uint64_t> parsedKeys(1, parsed.getKey());
+    UndoRecord undo;
+    while(command>>token){
+        MoveList list;
+        generateLegalMoves(&parsed, list);
+        Move found = NO_MOVE;
+        for(Move move: list){
+            if(moveToString(move) == token)
+                found = move;
+        }
+        if(found == NO_MOVE){
+            out.send("info string illegal move " + token);
+            return;
+        }
+        parsed.makeMove(found, undo);
+        parsedKeys.push_back(parsed.getKey());
+    }
+    chessBoard = parsed;
+    keys = parsedKeys;
+}
+
+void UciEngine::go(std::istringstream& command){
+    stopSearch();
+    SearchLimits limits;
+    int64_t time[2] = {0, 0}, increment[2] = {0, 0};
+    int movesToGo = 0;
+    bool timed = false;
+    infinite = false;
+    bool ponder = false;
+    std::string token;
+    while(command>>token){
+        if(token == "wtime" || token == "btime"){
+            command>>time[token[0] == 'w'];
+            timed = true;
+        }
+        else if(token == "winc" || token == "binc")
+            command>>increment[token[0] == 'w'];
+        else if(token == "movestogo")
+            command>>movesToGo;
+        else if(token == "movetime")
+            command>>limits.moveTime;
+        else if(token == "depth")
+            command>>limits.depth;
+        else if(token == "nodes")
+            command>>limits.nodes;
+        else if(token == "infinite")
+            infinite = true;
+        else if(token == "ponder")
+            ponder = true;
+    }
+
+    //A share of the clock for each of the moves still to make before the next time control, or 30 if there is none,
+    //plus most of the increment. Never more than the clock holds minus the overhead.
+    if(timed && limits.moveTime == 0){
+        int side = colorIndex(chessBoard.getTurn());
+        int64_t budget = time[side] / (movesToGo > 0? movesToGo : 30) + increment[side] * 3 / 4;
+        if(budget > time[side] - MOVE_OVERHEAD)
+            budget = time[side] - MOVE_OVERHEAD;
+        limits.moveTime = (budget > 1? budget : 1);
+    }
+    else if(limits.moveTime > MOVE_OVERHEAD)
+        limits.moveTime -= MOVE_OVERHEAD;
+    if(limits.depth < 1 || limits.depth > MAX_PLY - 1)
+        limits.depth = MAX_PLY - 1;
+
+    //A book move is played at once, except in an infinite search where the GUI wants analysis and while pondering,
+    //when a best move must wait for ponderhit
+    Move bookMove = (book.isOpen() && !infinite && !ponder? book.pick(&chessBoard, random()) : NO_MOVE);
+    if(bookMove != NO_MOVE){
+        out.send("bestmove " + moveToString(bookMove));
+        return;
+    }
+
+    stopRequested = false;
+    pondering = ponder;
+    ponderMove = NO_MOVE;
+    search.reset(new ParallelSearch(&chessBoard, tt, keys, threads));
+    search->onIteration = [this](const SearchReport& report){
+        ponderMove = (report.pv.size() > 1? report.pv[1] : NO_MOVE);
+        out.send(formatInfo(report, tt.hashfull()));
+    };
+    if(ponder)
+        search->ponder();
+    searchThread = std::thread([this, limits]{
+        Move best = search->run(limits);
+        {
+            std::unique_lock<std::mutex> guard(stopLock);
+            stopped.wait(guard, [this]{return stopRequested || (!infinite && !pondering);});
+        }
+        std::string reply = "bestmove " + (best == NO_MOVE? std::string("0000") : moveToString(best));
+        if(best != NO_MOVE && ponderMove != NO_MOVE)
+            reply += " ponder " + moveToString(ponderMove);
+        out.send(reply);
+    });
+}
+
+//The GUI's opponent played the move pondered on, so the search now keeps time and answers when it runs out
+void UciEngine::ponderHit(){
+    if(!searchThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> guard(stopLock);
+        pondering = false;
+    }
+    search->ponderHit();
+    stopped.notify_all();
+}
+
+void UciEngine::stopSearch(){
+    if(!searchThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> guard(stopLock);
+        stopRequested = true;
+    }
+    search->requestStop();
+    stopped.notify_all();
+    searchThread.join();
+}
+
+//"setoption name <Hash|Threads|TablebasePath|BookFile|EvalFile> value <megabytes|count|directory|file|file>"
+void UciEngine::setOption(std::istringstream& command){
+    //The name runs up to "value" and the value is the rest of the line, so either may contain spaces
+    std::string token, name, value;
+    command>>token;
+    while(command>>token && token != "value")
+        name += (name.empty()? "" : " ") + token;
+    std::getline(command>>std::ws, value);
+    while(!value.empty() && (value.back() == ' ' || value.back() == '\r'))
+        value.pop_back();
+    if(name == "Hash" && atoi(value.c_str()) > 0)
+        tt.resize(atoi(value.c_str()));
+    else if(name == "Threads" && atoi(value.c_str()) > 0)
+        threads = atoi(value.c_str());
+    else if(name == "TablebasePath" && !value.empty())
+        out.send("info string " + std::to_string(loadTablebases(value)) + " endgame tables loaded");
+    else if(name == "BookFile" && !book.open(value))
+        out.send("info string cannot read a book from " + value);
+    else if(name == "EvalFile"){
+        if(value.empty() || value == "<empty>")
+            unloadNetwork();
+        else if(!loadNetwork(value))
+            out.send("info string cannot read a network from " + value);
+    }
+}
+
+int UciEngine::loop(){
+    newGame(&chessBoard);
+    keys.assign(1, chessBoard.getKey());
+    std::string line, token;
+    while(std::getline(std::cin, line)){
+        std::istringstream command(line);
+        token.clear();
+        command>>token;
+        if(token == "uci"){
+            out.line("id name chess");
+            out.line("id author the chess authors");
+            out.line("option name Hash type spin default 16 min 1 max 65536");
+            out.line("option name Threads type spin default 1 min 1 max 256");
+            out.line("option name Ponder type check default false");
+            out.line("option name TablebasePath type string default <empty>");
+            out.line("option name BookFile type string default <empty>");
+            out.line("option name EvalFile type string default <empty>");
+            out.send("uciok");
+        }
+        else if(token == "isready")
+            out.send("readyok");
+        else if(token == "ucinewgame"){
+            stopSearch();
+            tt.clear();
+        }
+        else if(token == "setoption"){
+            stopSearch();
+            setOption(command);
+        }
+        else if(token == "position"){
+            stopSearch();
+            position(command);
+        }
+        else if(token == "go")
+            go(command);
+        else if(token == "stop")
+            stopSearch();
+        else if(token == "ponderhit")
+            ponderHit();
+        else if(token == "quit")
+            break;
+        else if(token == "stats"){
+            //Not part of UCI: "stats" for the counters of stats.h, "stats json" for them as one line, "stats reset"
+            command>>token;
+            if(token == "reset")
+                resetStats();
+            else if(token == "json")
+                out.send("info string " + statsJson());
+            else{
+                std::istringstream text(statsText());
+                while(std::getline(text, line))
+                    out.line("info string " + line);
+                out.flush();
+            }
+        }
+        else if(token == "d"){
+            printBoard(chessBoard.getTurn(), &chessBoard);
+            out.send(boardToFen(&chessBoard));
+        }
+        else if(!token.empty())
+            out.send("info string unknown command " + token);
+    }
+    stopSearch();
+    return 0;
+}
+
+int uciCommand(){
+    UciEngine engine;
+    return engine.loop();
+}
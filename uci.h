@@ -0,0 +1,7 @@
+#ifndef UCI_H
+#define UCI_H
+
+//Entry point for "chess uci", speaks the Universal Chess Interface on standard input and output until quit
+int uciCommand();
+
+#endif
@@ -0,0 +1,49 @@
+#include "zobrist.h"
+
+uint64_t zobristPieces[2][6][64];
+uint64_t zobristCastling[16];
+uint64_t zobristEnpassant[8];
+uint64_t zobristSide;
+
+//splitmix64 with a fixed seed, so keys are the same in every run and can be stored in files
+static uint64_t nextRandom(uint64_t& state){
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void initZobrist(){
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for(int color = 0; color < 2; color++){
+        for(int type = 0; type < 6; type++){
+            for(int square = 0; square < 64; square++)
+                zobristPieces[color][type][square] = nextRandom(state);
+        }
+    }
+    //Each castling right gets a key and a set of rights is the XOR of its members
+    uint64_t rightKeys[4];
+    for(int i = 0; i < 4; i++)
+        rightKeys[i] = nextRandom(state);
+    for(int rights = 0; rights < 16; rights++){
+        zobristCastling[rights] = 0;
+        for(int i = 0; i < 4; i++){
+            if(rights & (1 << i))
+                zobristCastling[rights] ^= rightKeys[i];
+        }
+    }
+    for(int file = 0; file < 8; file++)
+        zobristEnpassant[file] = nextRandom(state);
+    zobristSide = nextRandom(state);
+}
+
+int countRepetitions(const std::vector<uint64_t>& keys, int halfmoveClock){
+    int count = 0;
+    int last = int(keys.size()) - 1;
+    //Only positions with the same side to move can match, so step back two plies at a time
+    for(int i = last - 2; i >= 0 && i >= last - halfmoveClock; i -= 2){
+        if(keys[i] == keys[last])
+            count++;
+    }
+    return count;
+}
@@ -0,0 +1,19 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include <vector>
+
+//Random keys XORed together to identify a position, indexed like the ChessBoard bitboards
+extern uint64_t zobristPieces[2][6][64];
+extern uint64_t zobristCastling[16];
+extern uint64_t zobristEnpassant[8];
+extern uint64_t zobristSide; //Present when black is to move
+
+//Must be called once before any position keys are computed
+void initZobrist();
+
+//How many times the last key in keys occurred before, looking back no further than the last pawn move or capture
+int countRepetitions(const std::vector<uint64_t>& keys, int halfmoveClock);
+
+#endif